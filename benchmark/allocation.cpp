@@ -0,0 +1,49 @@
+#include <iostream>
+
+#include "benchmark.h"
+#include "../include/xf_cmd_parser.h"
+
+using v_t = xf::cmd::value_t;
+
+template<typename _FuncType>
+std::size_t Count(_FuncType func)
+{
+    std::size_t before = bench::counter().allocations;
+    func();
+    return bench::counter().allocations - before;
+}
+
+int main()
+{
+    xf::cmd::Parser parser(
+        { {{"-i", "--input"},    {v_t::vt_string,   false, true,  true}},
+          {{"-o", "--output"},   {v_t::vt_string,   false, false, true}},
+          {{"-t", "--threads"},  {v_t::vt_unsigned, false, false, true}},
+          {{"-r", "--ratio"},    {v_t::vt_float,    false, false, true}},
+          {{"-x", "--external"}, {v_t::vt_boolean,  false, false, false}},
+          {{"-f", "--format"},   {v_t::vt_string,   false, false, true, "xml|json|edn"}},
+          {{"-d", "--detail"},   {v_t::vt_nothing,  false, false, false}} });
+
+    const char* argv[] = { "app", "--input=/home/user/file", "-o", "/home/user/output", "--threads", "8",
+                           "-r=0.75", "-x", "true", "--format", "json", "-d" };
+    const std::size_t argc = std::extent<decltype(argv)>::value;
+    const std::size_t tokens = argc - 1;
+
+    std::string_view views[argc];
+    for (std::size_t i = 0; i < argc; ++i) views[i] = argv[i];
+
+    xf::cmd::list_t<xf::cmd::string_t> list(argv + 1, argv + argc);
+
+    std::size_t a = Count([&]() { parser.Parse(list); });
+    std::size_t b = Count([&]() { parser.Parse(argv, 1, argc); });
+    std::size_t c = Count([&]() { parser.ParseView(argv, 1, argc); });
+    std::size_t d = Count([&]() { parser.ParseView(views + 1, tokens); });
+
+    std::cout << "tokens per parse: " << tokens << std::endl;
+    std::cout << "Parse(list_t<string_t>): " << a << " allocations, " << double(a) / tokens << " per token" << std::endl;
+    std::cout << "Parse(argv):             " << b << " allocations, " << double(b) / tokens << " per token" << std::endl;
+    std::cout << "ParseView(argv):         " << c << " allocations, " << double(c) / tokens << " per token" << std::endl;
+    std::cout << "ParseView(string_view):  " << d << " allocations, " << double(d) / tokens << " per token" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "../include/xf_cmd_parser.h"
+
+using v_t = xf::cmd::value_t;
+using opt_t = xf::cmd::option_t;
+
+int main()
+{
+    xf::cmd::Parser parser;
+    for (int i = 0; i < 16; ++i)
+        parser.AddOption({ { "--path-" + std::to_string(i) }, opt_t(v_t::vt_string, false, false, true) })
+              .AddOption({ { "--count-" + std::to_string(i) }, opt_t(v_t::vt_unsigned, false, false, true) });
+
+    std::vector<std::string> args;
+    for (int i = 0; i < 16; ++i)
+    {
+        args.push_back("--path-" + std::to_string(i) + "=/home/user/workspace/project/file-" + std::to_string(i) + ".txt");
+        args.push_back("--count-" + std::to_string(i) + "=" + std::to_string(i * 1000));
+    }
+
+    std::vector<std::string_view> views(args.begin(), args.end());
+
+    // 每次解析使用栈上的缓冲区作为 arena, 解析结束后一次性释放
+    char buffer[16 * 1024];
+
+    bench::header();
+
+    bench::report("default [Parse]", args.size(), bench::measure([&]() {
+        parser.Parse(args);
+    }));
+    bench::report("arena [Parse]", args.size(), bench::measure([&]() {
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+        parser.Parse(args, &arena);
+    }));
+    bench::report("default [ParseView]", args.size(), bench::measure([&]() {
+        parser.ParseView(views.data(), views.size());
+    }));
+    bench::report("arena [ParseView]", args.size(), bench::measure([&]() {
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+        parser.ParseView(views.data(), views.size(), &arena);
+    }));
+
+    // 同一个 arena 连续处理多个请求, 每批结束后 release
+    std::pmr::monotonic_buffer_resource shared(buffer, sizeof(buffer));
+    bench::report("shared arena x8 [Parse]", args.size() * 8, bench::measure([&]() {
+        for (int i = 0; i < 8; ++i)
+            parser.Parse(args, &shared);
+        shared.release();
+    }));
+    bench::report("default x8 [Parse]", args.size() * 8, bench::measure([&]() {
+        for (int i = 0; i < 8; ++i)
+            parser.Parse(args);
+    }));
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "../include/xf_cmd_parser.h"
+
+using v_t = xf::cmd::value_t;
+
+int main()
+{
+    xf::cmd::Parser parser(
+        { {{"-i", "--input"},   {v_t::vt_string,   false, true,  true}},
+          {{"-o", "--output"},  {v_t::vt_string,   false, false, true}},
+          {{"-t", "--threads"}, {v_t::vt_unsigned, false, false, true}},
+          {{"-r", "--ratio"},   {v_t::vt_float,    false, false, true}},
+          {{"-l", "--level"},   {v_t::vt_string,   false, false, true, "L[1234]"}},
+          {{"-d", "--detail"},  {v_t::vt_nothing,  false, false, false}} });
+
+    const std::size_t total = 400000;
+
+    xf::cmd::list_t<xf::cmd::list_t<std::string>> batch;
+    batch.reserve(total);
+    for (std::size_t i = 0; i < total; ++i)
+        batch.push_back({ "--input=/var/spool/job/" + std::to_string(i), "-o", "/var/spool/out", "--threads", std::to_string(i % 64),
+                          "-r=0." + std::to_string(i % 100), "--level", "L" + std::to_string(1 + i % 4), "-d" });
+
+    auto frozen = parser.Freeze();
+
+    std::cout << "command lines: " << total << ", hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    frozen.ParseBatch(batch, 1);
+
+    double base = 0;
+    for (std::size_t threads : { 1, 2, 4, 8, 16 })
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto results = frozen.ParseBatch(batch, threads);
+        auto end = std::chrono::steady_clock::now();
+
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        if (1 == threads) base = ms;
+
+        std::size_t ok = 0;
+        for (auto& r : results) if (r) ++ok;
+
+        std::cout << "threads: " << threads << ", time: " << ms << " ms, " << (ms * 1e6 / total) << " ns/line"
+                  << ", speedup: " << (base / ms) << ", valid: " << ok << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+
+// 统计堆内存的分配次数和峰值, 只用于单线程的基准测试, 每个程序只能包含一次
+namespace bench
+{
+    struct counter_t
+    {
+        std::size_t allocations{ 0 };
+        std::size_t current{ 0 };
+        std::size_t peak{ 0 };
+    };
+
+    inline counter_t& counter()
+    {
+        static counter_t c;
+        return c;
+    }
+
+    struct sample_t
+    {
+        double ns{ 0 };                 // 每次调用的耗时
+        double allocations{ 0 };        // 每次调用的分配次数
+        std::size_t peak{ 0 };          // 单次调用期间的内存峰值(字节)
+    };
+
+    // 先单独调用一次统计内存, 再循环调用直到累计耗时超过 budget
+    template<typename _FuncType>
+    sample_t measure(_FuncType func, std::chrono::milliseconds budget = std::chrono::milliseconds(100))
+    {
+        sample_t s;
+
+        auto& c = counter();
+        std::size_t allocations = c.allocations;
+        std::size_t base = c.current;
+        c.peak = c.current;
+        func();
+        s.allocations = double(c.allocations - allocations);
+        s.peak = c.peak - base;
+
+        std::size_t n = 0;
+        auto start = std::chrono::steady_clock::now();
+        auto end = start;
+        for (std::size_t batch = 1; end - start < budget; batch *= 2)
+        {
+            for (std::size_t i = 0; i < batch; ++i) func();
+            n += batch;
+            end = std::chrono::steady_clock::now();
+        }
+
+        s.ns = std::chrono::duration<double, std::nano>(end - start).count() / double(n);
+        return s;
+    }
+
+    inline void header()
+    {
+        std::cout << std::left << std::setw(52) << "case" << std::right
+                  << std::setw(8) << "args" << std::setw(14) << "ns/parse" << std::setw(10) << "ns/arg"
+                  << std::setw(14) << "allocs/parse" << std::setw(14) << "peak bytes" << std::endl;
+    }
+
+    inline void report(const std::string& name, std::size_t args, const sample_t& s)
+    {
+        std::cout << std::left << std::setw(52) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(8) << args << std::setw(14) << s.ns << std::setw(10) << (args ? s.ns / double(args) : 0.0)
+                  << std::setw(14) << s.allocations << std::setw(14) << s.peak << std::endl;
+    }
+
+}   // namespace bench
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// 在每块内存前保存其大小, 以便统计当前占用
+void* operator new(std::size_t n)
+{
+    auto& c = bench::counter();
+    ++c.allocations;
+    c.current += n;
+    if (c.peak < c.current) c.peak = c.current;
+
+    if (void* p = std::malloc(n + alignof(std::max_align_t)))
+    {
+        *static_cast<std::size_t*>(p) = n;
+        return static_cast<char*>(p) + alignof(std::max_align_t);
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    if (p)
+    {
+        void* q = static_cast<char*>(p) - alignof(std::max_align_t);
+        bench::counter().current -= *static_cast<std::size_t*>(q);
+        std::free(q);
+    }
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+// std::pmr::new_delete_resource 使用带对齐参数的版本
+void* operator new(std::size_t n, std::align_val_t al)
+{
+    std::size_t a = std::max(static_cast<std::size_t>(al), alignof(std::max_align_t));
+
+    auto& c = bench::counter();
+    ++c.allocations;
+    c.current += n;
+    if (c.peak < c.current) c.peak = c.current;
+
+    if (void* p = std::aligned_alloc(a, (n + a + a - 1) / a * a))
+    {
+        *static_cast<std::size_t*>(p) = n;
+        return static_cast<char*>(p) + a;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p, std::align_val_t al) noexcept
+{
+    if (p)
+    {
+        std::size_t a = std::max(static_cast<std::size_t>(al), alignof(std::max_align_t));
+        void* q = static_cast<char*>(p) - a;
+        bench::counter().current -= *static_cast<std::size_t*>(q);
+        std::free(q);
+    }
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t al) noexcept
+{
+    operator delete(p, al);
+}
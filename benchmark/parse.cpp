@@ -0,0 +1,280 @@
+﻿#include <map>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "../include/xf_cmd_parser.h"
+
+using v_t = xf::cmd::value_t;
+using opt_t = xf::cmd::option_t;
+
+namespace
+{
+    const v_t types[] = { v_t::vt_boolean, v_t::vt_integer, v_t::vt_unsigned, v_t::vt_float, v_t::vt_string, v_t::vt_nothing };
+    const char* names[] = { "boolean", "integer", "unsigned", "float", "string", "nothing" };
+    const char* values[] = { "true", "-42", "42", "3.25", "/home/user/workspace/file.txt", "" };
+
+    std::string Key(std::size_t i) { return "--option-" + std::to_string(i); }
+
+    // 第 i 个参数的值类型为 types[i % 6]
+    xf::cmd::Parser MakeParser(std::size_t n)
+    {
+        xf::cmd::Parser parser;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            v_t vt = types[i % 6];
+            if (v_t::vt_nothing == vt)
+                parser.AddOption({ { Key(i), "-o" + std::to_string(i) }, opt_t(false, false) });
+            else
+                parser.AddOption({ { Key(i), "-o" + std::to_string(i) }, opt_t(vt, false, false, true) });
+        }
+
+        return parser;
+    }
+
+    std::vector<std::string> MakeArgs(std::size_t schema, std::size_t count, bool equation, int type = -1)
+    {
+        std::vector<std::string> args;
+        for (std::size_t i = 0, n = 0; n < count && i < schema; ++i)
+        {
+            std::size_t t = i % 6;
+            if (0 <= type && t != std::size_t(type))
+                continue;
+
+            ++n;
+            if (v_t::vt_nothing == types[t])
+            {
+                args.push_back(Key(i));
+            }
+            else if (equation)
+            {
+                args.push_back(Key(i) + "=" + values[t]);
+            }
+            else
+            {
+                args.push_back(Key(i));
+                args.push_back(values[t]);
+            }
+        }
+
+        return args;
+    }
+
+    // 编译期参数表: 64 个整数参数 "--static-00" ~ "--static-63", 短名 "-s00" ~ "-s63"
+    template<std::size_t i>
+    struct s_option : xf::cmd::static_option_t<int, false, false, true>
+    {
+        static constexpr char long_key[]{ '-', '-', 's', 't', 'a', 't', 'i', 'c', '-', char('0' + i / 10), char('0' + i % 10), '\0' };
+        static constexpr char short_key[]{ '-', 's', char('0' + i / 10), char('0' + i % 10), '\0' };
+        static constexpr const char* keys[]{ long_key, short_key };
+    };
+
+    template<std::size_t... i>
+    xf::cmd::StaticParser<s_option<i>...> MakeStaticParser(std::index_sequence<i...>) { return {}; }
+
+    void Run(const std::string& name, const xf::cmd::Parser& parser, const std::vector<std::string>& args)
+    {
+        std::vector<std::string_view> views(args.begin(), args.end());
+
+        bench::report(name + " [Parse]", args.size(), bench::measure([&]() { parser.Parse(args); }));
+        bench::report(name + " [ParseView]", args.size(), bench::measure([&]() { parser.ParseView(views.data(), views.size()); }));
+    }
+}
+
+int main()
+{
+    bench::header();
+
+    for (std::size_t schema : { 10, 100, 2000 })
+    {
+        auto parser = MakeParser(schema);
+        for (std::size_t count : { 4, 16, 64 })
+        {
+            if (schema < count) continue;
+
+            std::string name = "schema " + std::to_string(schema) + ", " + std::to_string(count) + " keys";
+            Run(name + ", --k v", parser, MakeArgs(schema, count, false));
+            Run(name + ", --k=v", parser, MakeArgs(schema, count, true));
+        }
+    }
+
+    // 补全: 5000 个参数中以 "--option-12" 开头的有 111 个, 对比取出全部参数名后过滤
+    auto large = MakeParser(5000);
+    bench::report("complete prefix, schema 5000 [GetKeys + filter]", 1, bench::measure([&]() {
+        std::vector<std::string> candidates;
+        for (auto& key : large.GetKeys())
+            if (0 == key.compare(0, 11, "--option-12")) candidates.push_back(key);
+    }));
+    bench::report("complete prefix, schema 5000 [Complete]", 1, bench::measure([&]() { large.Complete({}, "--option-12"); }));
+    bench::report("complete value, schema 5000 [Complete]", 1, bench::measure([&]() { large.Complete({ "--option-0" }, ""); }));
+
+    auto parser = MakeParser(100);
+    for (int t = 0; t < 6; ++t)
+        Run(std::string("value ") + names[t] + ", 16 keys", parser, MakeArgs(100, 16, true, t));
+
+    // 编译期参数表与运行时参数表相同, 对比两种解析器
+    auto fixed = MakeStaticParser(std::make_index_sequence<64>());
+    xf::cmd::Parser dynamic;
+    std::vector<std::string> statics;
+    for (std::size_t i = 0; i < 64; ++i)
+    {
+        std::string digits{ char('0' + i / 10), char('0' + i % 10) };
+        dynamic.AddOption({ { "--static-" + digits, "-s" + digits }, opt_t(v_t::vt_integer, false, false, true) });
+        if (0 == i % 4) statics.push_back((i % 8 ? "-s" : "--static-") + digits + "=42");
+    }
+
+    bench::report("static schema 64, 16 keys [Parser]", statics.size(), bench::measure([&]() { dynamic.Parse(statics); }));
+    bench::report("static schema 64, 16 keys [StaticParser]", statics.size(), bench::measure([&]() { fixed.Parse(statics); }));
+
+    // 出现的 16 个参数各有一组互斥、至少一个和依赖约束, 全部满足
+    auto constrained = MakeParser(100);
+    for (std::size_t i = 0; i < 16; ++i)
+    {
+        constrained.AddExclusive({ Key(i), Key(16 + i) })
+                   .AddAtLeastOne({ Key(i), Key(32 + i) })
+                   .AddRequires(Key(i), { Key((i + 1) % 16) });
+    }
+    Run("constraints 48, schema 100, 16 keys", constrained, MakeArgs(100, 16, true));
+
+    // 统计关闭、只计数和计时三种情况
+    auto counted = MakeParser(100), timed = MakeParser(100);
+    counted.EnableMetrics();
+    timed.EnableMetrics(true, true);
+    Run("metrics off, 16 keys", parser, MakeArgs(100, 16, true));
+    Run("metrics counters, 16 keys", counted, MakeArgs(100, 16, true));
+    Run("metrics timing, 16 keys", timed, MakeArgs(100, 16, true));
+
+    xf::cmd::Parser patterns(
+        { {{"-f", "--format"}, opt_t(v_t::vt_string,  false, false, true, std::string("xml|json|edn"))},
+          {{"-l", "--level"},  opt_t(v_t::vt_string,  false, false, true, std::string("L[1234]"))},
+          {{"-z", "--zone"},   opt_t(v_t::vt_integer, false, false, true, std::string("[12][0-9]"))},
+          {{"-r", "--repeat"}, opt_t(v_t::vt_string,  false, false, true, std::string("(ab)+"))},
+          {{"-c", "--custom"}, opt_t(v_t::vt_unsigned, false, false, true, [](const std::string& v) { return opt_t::is_unsigned(v); })} });
+    Run("pattern dfa", patterns, { "--format=json", "--level=L3", "-z", "17" });
+    Run("pattern regex", patterns, { "--repeat=ababab" });
+    Run("pattern callback", patterns, { "--custom=12345" });
+
+    // 自定义类型: 64 位整数保存在结果内部, 不额外分配
+    xf::cmd::Parser converters(
+        { {{"-s", "--size"},  opt_t::make<std::uint64_t>(false, false, true)},
+          {{"-d", "--delta"}, opt_t::make<std::int64_t>(false, false, true)},
+          {{"-g", "--gain"},  opt_t::make<float>(false, false, true)},
+          {{"-n", "--count"}, opt_t::make<unsigned int>(false, false, true)} });
+    Run("converter int64/uint64/float", converters, { "--size=18446744073709551615", "--delta=-9223372036854775808", "--gain=0.5" });
+    Run("builtin unsigned", converters, { "--count=4294967295" });
+
+    // ParseInto 直接写入结构体, 对比 Parse 之后逐个 get
+    struct config_t { std::string input, output; unsigned int threads; int level; double ratio; bool detail; } cfg{};
+    xf::cmd::Parser binder;
+    binder.Bind(&config_t::input, { "-i", "--input" })
+          .Bind(&config_t::output, { "-o", "--output" })
+          .Bind(&config_t::threads, { "-t", "--threads" })
+          .Bind(&config_t::level, { "-l", "--level" })
+          .Bind(&config_t::ratio, { "-r", "--ratio" })
+          .Bind(&config_t::detail, { "-d", "--detail" }, opt_t(false, false));
+
+    std::vector<std::string> bound{ "--input=/home/user/workspace/input.txt", "--output=/home/user/workspace/output.txt",
+                                    "--threads=16", "--level=-3", "--ratio=0.75", "--detail" };
+
+    bench::report("bind [Parse + get]", bound.size(), bench::measure([&]() {
+        auto result = binder.Parse(bound);
+        cfg.input = result.get<std::string>("--input");
+        cfg.output = result.get<std::string>("--output");
+        cfg.threads = result.get<unsigned int>("--threads");
+        cfg.level = result.get<int>("--level");
+        cfg.ratio = result.get<double>("--ratio");
+        cfg.detail = result.is_existing("--detail");
+    }));
+    bench::report("bind [ParseInto]", bound.size(), bench::measure([&]() { binder.ParseInto(bound, cfg); }));
+
+    // 可以重复的参数, 10000 个 include 路径
+    xf::cmd::Parser lists(
+        { {{"-I", "--include"}, opt_t(v_t::vt_string, false, false, true).multiple()},
+          {{"-D", "--define"},  opt_t(v_t::vt_integer, false, false, true).multiple(',')} });
+
+    std::vector<std::string> includes;
+    for (int i = 0; i < 10000; ++i)
+    {
+        includes.push_back("-I");
+        includes.push_back("/home/user/workspace/project/include/" + std::to_string(i));
+    }
+    Run("multiple, 10000 x -I path", lists, includes);
+
+    std::string defines("--define=");
+    for (int i = 0; i < 10000; ++i)
+        defines += std::to_string(i) + ",";
+    defines.pop_back();
+    Run("multiple, 10000 integers in one value", lists, { defines });
+
+    // 4 个来源合并, 对比分别解析后合并 args()
+    std::vector<std::vector<std::string>> layers{ MakeArgs(100, 16, true), MakeArgs(100, 16, true), MakeArgs(100, 8, true), MakeArgs(100, 4, true) };
+    bench::report("layers [Parse x4 + merge args()]", 44, bench::measure([&]() {
+        std::map<std::string, std::string> merged;
+        for (auto& layer : layers)
+            for (auto& item : parser.Parse(layer).args())
+                merged[item.first] = item.second;
+    }));
+    bench::report("layers [ParseLayers]", 44, bench::measure([&]() { parser.ParseLayers(layers); }));
+
+    // 控制命令只修改中间的一个值
+    auto command = MakeArgs(100, 16, false);
+    auto previous = parser.Reparse(xf::cmd::result_t(), command);
+    auto changed = command;
+    changed[14] = "-7";
+    bench::report("reparse one value [Parse]", changed.size(), bench::measure([&]() { parser.Parse(changed); }));
+    bench::report("reparse one value [Reparse]", changed.size(), bench::measure([&]() { parser.Reparse(previous, changed); }));
+
+    // 反复解析相同的几百个命令行: 300 个不同的命令行按顺序循环, 缓存容量足够时全部命中
+    std::vector<std::vector<std::string>> jobs;
+    for (std::size_t i = 0; i < 300; ++i)
+    {
+        jobs.push_back(MakeArgs(100, 16, true));
+        jobs.back().push_back("--option-4=" + std::to_string(i));
+    }
+
+    auto cached = MakeParser(100);
+    cached.EnableCache(512);
+    std::size_t job = 0;
+    bench::report("300 command lines, 17 keys [Parse]", 17, bench::measure([&]() { parser.Parse(jobs[job++ % jobs.size()]); }));
+    bench::report("300 command lines, 17 keys [ParseCached]", 17, bench::measure([&]() { cached.ParseCached(jobs[job++ % jobs.size()]); }));
+
+    // 启动器解析一次后把结果交给工作进程, 对比工作进程重新解析
+    auto forked = MakeParser(2000);
+    auto argv = MakeArgs(2000, 64, false);
+    std::string serialized = forked.Parse(argv).serialize();
+    bench::report("handoff 64 keys [Parse]", argv.size(), bench::measure([&]() { forked.Parse(argv); }));
+    bench::report("handoff 64 keys [Parse + serialize]", argv.size(), bench::measure([&]() { forked.Parse(argv).serialize(); }));
+    bench::report("handoff 64 keys [Deserialize]", argv.size(), bench::measure([&]() { forked.Deserialize(serialized); }));
+    bench::report("handoff 64 keys [DeserializeView]", argv.size(), bench::measure([&]() { forked.DeserializeView(serialized); }));
+
+    // 120 个子命令, 每个 20 个参数: 启动时构造全部子命令的解析器, 对比只构造选中的子命令
+    std::vector<std::string> invocation{ "--option-1=-42", "command-7" };
+    for (auto& arg : MakeArgs(20, 8, true)) invocation.push_back(arg);
+
+    bench::report("commands 120 x 20 keys [eager setup + Parse]", invocation.size(), bench::measure([&]() {
+        std::map<std::string, xf::cmd::Parser> commands;
+        for (int i = 0; i < 120; ++i)
+            commands.emplace("command-" + std::to_string(i), MakeParser(20));
+
+        auto global = MakeParser(6);
+        auto result = global.Parse({ invocation[0] });
+        commands.at(invocation[1]).Parse(std::vector<std::string>(invocation.begin() + 2, invocation.end()));
+    }));
+    bench::report("commands 120 x 20 keys [AddCommand + Parse]", invocation.size(), bench::measure([&]() {
+        auto global = MakeParser(6);
+        for (int i = 0; i < 120; ++i)
+            global.AddCommand("command-" + std::to_string(i), [](xf::cmd::Parser& p) { p = MakeParser(20); });
+
+        global.Parse(invocation);
+    }));
+
+    auto args = MakeArgs(2000, 16, true);
+    args.push_back("--unknown-option");
+    Run("error s_k_unrecognized, schema 2000", MakeParser(2000), args);
+
+    args = MakeArgs(100, 16, true);
+    args.push_back("--option-1=abc");
+    Run("error s_v_error, schema 100", parser, args);
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/xf_cmd_parser.h"
+
+using opt_t = xf::cmd::option_t;
+
+namespace
+{
+    xf::cmd::Parser MakeParser()
+    {
+        xf::cmd::Parser parser;
+        for (int i = 0; i < 100; ++i)
+            parser.AddOption({ { "--option-" + std::to_string(i) }, opt_t::make<std::string>(false, false, true) });
+
+        return parser;
+    }
+
+    // threads 个线程解析 duration 时间, 同时一个线程每隔 interval 添加一个参数, 返回每秒的解析次数
+    template<typename _ParseType, typename _AddType>
+    double Run(std::size_t threads, std::chrono::milliseconds duration, std::chrono::microseconds interval, _ParseType parse, _AddType add)
+    {
+        std::atomic<bool> stop{ false };
+        std::atomic<std::size_t> count{ 0 };
+
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&]() {
+                const xf::cmd::list_t<std::string> args{ "--option-1=/home/user/a", "--option-50=/home/user/b", "--option-99=/home/user/c" };
+                std::size_t n = 0;
+                for (; !stop; ++n)
+                    parse(args);
+                count += n;
+            });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; std::chrono::steady_clock::now() - start < duration; ++i)
+        {
+            add("--plugin-" + std::to_string(i));
+            std::this_thread::sleep_for(interval);
+        }
+
+        stop = true;
+        for (auto& t : workers)
+            t.join();
+
+        return double(count) / std::chrono::duration<double>(duration).count();
+    }
+}
+
+int main()
+{
+    const auto duration = std::chrono::milliseconds(500);
+    const auto interval = std::chrono::microseconds(10000);
+
+    std::cout << "parsing while a writer adds an option every " << interval.count() << " us, hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    for (std::size_t threads : { 1, 2, 4, 8 })
+    {
+        // 整个解析器加锁
+        xf::cmd::Parser locked = MakeParser();
+        std::mutex mutex;
+        double a = Run(threads, duration, interval,
+            [&](const xf::cmd::list_t<std::string>& args) { std::lock_guard<std::mutex> lock(mutex); locked.Parse(args); },
+            [&](const std::string& key) { std::lock_guard<std::mutex> lock(mutex); locked.AddOption({ { key }, opt_t::make<std::string>(false, false, true) }); });
+
+        xf::cmd::SharedParser shared(MakeParser());
+        double b = Run(threads, duration, interval,
+            [&](const xf::cmd::list_t<std::string>& args) { shared.Parse(args); },
+            [&](const std::string& key) { shared.AddOption({ { key }, opt_t::make<std::string>(false, false, true) }); });
+
+        std::cout << "threads: " << threads << ", mutex: " << std::size_t(a) << " parses/s, SharedParser: " << std::size_t(b)
+                  << " parses/s, speedup: " << (b / a) << std::endl;
+    }
+
+    return 0;
+}
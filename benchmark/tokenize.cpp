@@ -0,0 +1,71 @@
+#include <string>
+#include <string_view>
+
+#include "benchmark.h"
+#include "../include/xf_cmd_parser.h"
+
+using opt_t = xf::cmd::option_t;
+
+namespace
+{
+    // 约 size 字节的命令行, quoted 为 true 时一半的值带引号和转义
+    std::string MakeLine(std::size_t size, bool quoted)
+    {
+        std::string line;
+        for (std::size_t i = 0; line.size() < size; ++i)
+        {
+            std::string path = "/home/user/workspace/project/include/module-" + std::to_string(i);
+            if (quoted && 0 == i % 2)
+                line += (0 == i % 4 ? " -I \"" + path + " (copy) \\\"v2\\\"\"" : " -I '" + path + " (copy)'");
+            else
+                line += " -I " + path;
+        }
+
+        return line;
+    }
+
+    void Report(const std::string& name, std::size_t bytes, std::size_t args, const bench::sample_t& s)
+    {
+        bench::report(name, args, s);
+        std::cout << std::left << std::setw(52) << "" << std::right << std::fixed << std::setprecision(2)
+                  << double(bytes) / s.ns << " GB/s" << std::endl;
+    }
+}
+
+int main()
+{
+    xf::cmd::Parser parser;
+    parser.AddOption({ {"-I", "--include"}, opt_t::make<std::string>(false, false, true).multiple() });
+
+#if defined(XF_CMD_USE_SSE2)
+    const std::string mode(" (sse2)");
+#else
+    const std::string mode(" (scalar)");
+#endif
+
+    bench::header();
+
+    for (bool quoted : { false, true })
+    {
+        std::string line = MakeLine(4 * 1024 * 1024, quoted);
+        std::string name = std::string(quoted ? "quoted" : "plain") + " 4MB";
+
+        std::size_t count = 0;
+        xf::cmd::_tokenizer_t counter(line);
+        for (std::string_view token; counter.next(token); ++count);
+
+        volatile std::size_t total = 0;
+        Report(name + " [tokenize]" + mode, line.size(), count, bench::measure([&]() {
+            std::size_t n = 0;
+            xf::cmd::_tokenizer_t tokens(line);
+            for (std::string_view token; tokens.next(token); n += token.size());
+            total = n;
+        }, std::chrono::milliseconds(500)));
+
+        Report(name + " [ParseCommandLine]" + mode, line.size(), count, bench::measure([&]() {
+            parser.ParseCommandLine(line);
+        }, std::chrono::milliseconds(500)));
+    }
+
+    return 0;
+}
@@ -1,10 +1,25 @@
 ﻿#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <memory_resource>
+#include <list>
+#include <random>
+#include <thread>
 
 #include "../include/xf_cmd_parser.h"
 
 using v_t = xf::cmd::value_t;
 using opt_t = xf::cmd::option_t;
 
+void SetEnv(const char* name, const char* value)
+{
+#if defined(_WIN32)
+    _putenv_s(name, value ? value : "");
+#else
+    if (value) setenv(name, value, 1); else unsetenv(name);
+#endif
+}
+
 void Show(const xf::cmd::result_t& result)
 {
     std::cout << "parse result: code: " << result.code() << ", info: " << result.info() << std::endl;
@@ -148,9 +163,1253 @@ bool test_3()
     return (p1 && p2 && p3 && p4 && p5 && p6 && p7 && p8);
 }
 
+bool test_4()
+{
+    struct { const char* text; bool b, i, u, f; } table[] = {
+        { "true",        true,  false, false, false },
+        { "False",       true,  false, false, false },
+        { "TRUE",        true,  false, false, false },
+        { "tRUE",        false, false, false, false },
+        { "0",           false, true,  true,  true  },
+        { "7",           false, true,  true,  true  },
+        { "+7",          false, true,  false, true  },
+        { "-0",          false, true,  false, true  },
+        { "07",          false, false, false, false },
+        { "10",          false, true,  true,  true  },
+        { "10.5",        false, false, false, true  },
+        { "-0.25",       false, false, false, true  },
+        { "1.",          false, false, false, false },
+        { ".5",          false, false, false, false },
+        { "1e3",         false, false, false, false },
+        { "2147483647",  false, true,  true,  true  },
+        { "2147483648",  false, false, true,  true  },
+        { "-2147483648", false, true,  false, true  },
+        { "4294967295",  false, false, true,  true  },
+        { "99999999999", false, false, false, true  },
+        { "",            false, false, false, false },
+        { "-",           false, false, false, false },
+        { " 1",          false, false, false, false } };
+
+    bool ok = true;
+    for (auto& t : table)
+    {
+        bool pass = (opt_t::is_boolean(t.text) == t.b && opt_t::is_integer(t.text) == t.i
+                  && opt_t::is_unsigned(t.text) == t.u && opt_t::is_float(t.text) == t.f);
+        if (!pass) std::cout << "conformance failed: \"" << t.text << "\"" << std::endl;
+        ok = ok && pass;
+    }
+
+    xf::cmd::Parser parser(
+        { {{"-i"}, opt_t::make<int>(false, false, true)},
+          {{"-u"}, opt_t::make<unsigned int>(false, false, true)},
+          {{"-f"}, opt_t::make<double>(false, false, true)} });
+
+    auto result = parser.Parse({ "-i=-2147483648", "-u=4294967295", "-f=10.5" });
+    Show(result);
+    bool p1 = (result && result.get<int>("-i") == INT_MIN
+                      && result.get<unsigned int>("-u") == 4294967295u
+                      && result.get<double>("-f") == 10.5);
+
+    result = parser.Parse({ "-i", "99999999999" });
+    Show(result);
+    bool p2 = (!result && xf::cmd::state_t::s_v_error == result.code());
+
+    return (ok && p1 && p2);
+}
+
+bool test_5()
+{
+    const char* patterns[] = { "xml|json|edn", "L[1234]", "[12][0-9]", "[1-9][0-9]*", "a?b+|c", "[^0-9]+",
+                               "\\d\\.\\d", "", "x|", "(ab)+", "a{2}", ".*" };
+    const char* values[] = { "", "xml", "json", "edn", "xm", "jsonx", "L1", "L5", "L12", "19", "20", "30", "1",
+                             "100", "b", "abb", "bbb", "c", "ab", "abab", "aa", "x", "1.5", "1x5", "abc" };
+
+    bool ok = true;
+    for (auto p : patterns)
+    {
+        opt_t opt(v_t::vt_string, false, false, true, p);
+        for (auto v : values)
+        {
+            if (opt.check(v) != std::regex_match(v, std::regex(p)))
+            {
+                std::cout << "pattern mismatch: \"" << p << "\" with \"" << v << "\"" << std::endl;
+                ok = false;
+            }
+        }
+    }
+
+    bool p1 = false;
+    try {
+        opt_t::make<std::string>(false, false, true, "[a-");
+    } catch (const std::regex_error&) {
+        p1 = true;
+    }
+
+    return (ok && p1);
+}
+
+bool test_6()
+{
+    xf::cmd::Parser parser(
+        { {{"-a", "--a"},  opt_t::make<int>(false, false, true)},
+          {{"-ab", "--ab"}, opt_t::make<std::string>(false, false, false)} });
+
+    auto result = parser.Parse({ "--ab=--a", "-a=1" });
+    Show(result);
+    bool p1 = (result && result.get<std::string>("-ab") == "--a" && result.get<int>("--a") == 1);
+
+    result = parser.Parse({ "--abc=1" });
+    Show(result);
+    bool p2 = (!result && xf::cmd::state_t::s_k_unrecognized == result.code());
+
+    parser.RemoveOption({ "-ab" });
+    result = parser.Parse({ "-ab" });
+    Show(result);
+    bool p3 = (!result && xf::cmd::state_t::s_k_unrecognized == result.code());
+
+    result = parser.Parse({ "--ab", "-a", "2" });
+    Show(result);
+    bool p4 = (result && !result.has_value("-ab") && result.get<int>("-a") == 2);
+
+    parser.AddOption({ {"-ab", "-a"}, opt_t::make<bool>(false, false, true) });
+    result = parser.Parse({ "-a=true", "--a=3" });
+    Show(result);
+    bool p5 = (result && result.get<bool>("-ab") && result.get<int>("--a") == 3 && !parser.IsSame("-a", "--a"));
+
+    return (p1 && p2 && p3 && p4 && p5);
+}
+
+bool test_7()
+{
+    xf::cmd::Parser parser(
+        { {{"-i", "--input"},  opt_t::make<std::string>(false, true, true)},
+          {{"-l", "--level"},  opt_t::make<std::string>(false, false, true, "L[1234]")},
+          {{"-n", "--number"}, opt_t::make<int>(false, false, false)} });
+
+    std::string input("/home/file");
+    std::string_view args[] = { "-i", input, "--level=L3", "-n" };
+
+    auto result = parser.ParseView(args, std::extent<decltype(args)>::value);
+    Show(result);
+    bool p1 = (result && result.get<std::string_view>("--input").data() == input.data()
+                      && result.get<std::string>("-i") == input
+                      && result.get<std::string_view>("-l") == "L3"
+                      && result.is_existing("--number") && !result.has_value("-n"));
+
+    const char* argv[] = { "app", "--input=/etc/dir", "-l", "L5" };
+    result = parser.ParseView(argv, 1, std::extent<decltype(argv)>::value);
+    Show(result);
+    bool p2 = (!result && xf::cmd::state_t::s_v_error == result.code() && result.hint().second == "L5");
+
+    result = parser.Parse(argv, 1, 2);
+    bool p3 = (result && result.get<std::string_view>("-i") == "/etc/dir");
+
+    return (p1 && p2 && p3);
+}
+
+bool test_8()
+{
+    xf::cmd::result_t result = xf::cmd::Parser().Parse({ "-a" });
+    bool p1 = (!result && xf::cmd::state_t::s_k_unrecognized == result.code() && !result.is_existing("-a"));
+
+    {
+        xf::cmd::Parser parser(
+            { {{"-n", "--name"},  opt_t::make<std::string>(false, true, true)},
+              {{"-c", "--count"}, opt_t::make<unsigned int>(false, false, false)} });
+
+        result = parser.Parse({ "--count", "--name=xf-bnb" });
+        parser.RemoveOption({ "-n", "--name" });
+        parser.AddOption({ {"-c", "--count"}, opt_t::make<int>(false, false, true) });
+    }
+
+    Show(result);
+    auto values = result.get();
+    bool p2 = (result && result.get<std::string>("-n") == "xf-bnb" && result.is_existing("-c") && !result.has_value("--count")
+                      && 2 == values.size() && 1 == values.count("--name") && 1 == values.count("--count")
+                      && result.get<int>("--count", 5) == 5 && result.get<int>("--size", 7) == 7);
+
+    return (p1 && p2);
+}
+
+struct s_input  : xf::cmd::static_option_t<std::string_view, false, true, true>  { static constexpr const char* keys[]{ "-i", "--input" }; };
+struct s_level  : xf::cmd::static_option_t<int, false, false, true>              { static constexpr const char* keys[]{ "-l", "--level" };
+                                                                                   static bool check(std::string_view v) { return (1 == v.size()); } };
+struct s_ratio  : xf::cmd::static_option_t<double, false, false, false>          { static constexpr const char* keys[]{ "-r", "--ratio" }; };
+struct s_detail : xf::cmd::static_option_t<std::nullptr_t, false, false, false>  { static constexpr const char* keys[]{ "-d", "--detail" }; };
+struct s_help   : xf::cmd::static_option_t<std::nullptr_t, true, false, false>   { static constexpr const char* keys[]{ "-h", "--help" }; };
+struct s_in     : xf::cmd::static_option_t<int, false, false, true>              { static constexpr const char* keys[]{ "--in", "-in", "--inputs" }; };
+
+bool test_9()
+{
+    xf::cmd::StaticParser<s_input, s_level, s_ratio, s_detail, s_help> parser;
+
+    auto result = parser.Parse({ "--input=/home/file", "-l", "3", "-r", "-d" });
+    bool p1 = (result && result.get<s_input>() == "/home/file" && result.get<s_level>() == 3
+                      && result.is_existing<s_ratio>() && !result.has_value<s_ratio>() && result.get<s_ratio>(0.5) == 0.5
+                      && result.is_existing<s_detail>() && !result.is_existing<s_help>());
+
+    result = parser.Parse({ "-i", "/home/file", "-l", "12" });
+    bool p2 = (!result && xf::cmd::state_t::s_v_error == result.code());
+
+    result = parser.Parse({ "-l=1", "-d" });
+    bool p3 = (!result && xf::cmd::state_t::s_k_missing == result.code() && result.hint().first == "-i");
+
+    result = parser.Parse({ "-h" });
+    bool p4 = (result && result.is_existing<s_help>());
+
+    result = parser.Parse({ "-i=a", "--input=b" });
+    bool p5 = (!result && xf::cmd::state_t::s_k_duplicated == result.code());
+
+    result = parser.Parse({ "-i=a", "--detail=1" });
+    bool p6 = (!result && xf::cmd::state_t::s_v_redundant == result.code());
+
+    result = parser.Parse({ "-i=a", "-x" });
+    bool p7 = (!result && xf::cmd::state_t::s_k_unrecognized == result.code());
+
+    std::cout << "static parser: " << result.info() << std::endl << std::endl;
+
+    // 参数名互为前缀时取最长的一个
+    xf::cmd::StaticParser<s_in, s_input, s_detail> prefixed;
+    auto r1 = prefixed.Parse({ "--input=a", "--in=1", "-d" });
+    auto r2 = prefixed.Parse({ "-in", "2", "-i", "b" });
+    auto r3 = prefixed.Parse({ "--inputs=3", "-i=c" });
+    auto r4 = prefixed.Parse({ "-i=c", "--inp=3" });
+    auto r5 = prefixed.Parse({ "-i=c", "--input" });
+    bool p8 = (r1 && r1.get<s_input>() == "a" && r1.get<s_in>() == 1 && r1.is_existing<s_detail>()
+                  && r2 && r2.get<s_in>() == 2 && r2.get<s_input>() == "b"
+                  && r3 && r3.get<s_in>() == 3 && r3.get<s_input>() == "c"
+                  && !r4 && xf::cmd::state_t::s_k_unrecognized == r4.code()
+                  && !r5 && xf::cmd::state_t::s_k_duplicated == r5.code());
+
+    return (p1 && p2 && p3 && p4 && p5 && p6 && p7 && p8);
+}
+
+bool test_10()
+{
+    xf::cmd::handle_t<int> threads;
+    xf::cmd::handle_t<std::nullptr_t> verbose;
+
+    xf::cmd::Parser parser;
+    parser.AddOption({ {"-t", "--threads"}, opt_t::make<int>(false, false, true) }, threads)
+          .AddOption({ {"-v", "--verbose"}, opt_t::make<nullptr_t>(false, false) }, verbose)
+          .AddOption({ {"-o", "--output"},  opt_t::make<std::string>(false, false, false) });
+
+    auto output = parser.GetHandle<std::string>("--output");
+    auto missing = parser.GetHandle<int>("--missing");
+
+    auto result = parser.Parse({ "--threads=8", "-o" });
+    bool p1 = (result && threads && output && !missing
+                      && result.get(threads) == 8 && result.has_value(threads)
+                      && !result.is_existing(verbose) && result.is_existing(output) && !result.has_value(output)
+                      && result.get(output, std::string("out")) == "out" && result.get(missing, 3) == 3);
+
+    result = parser.Parse({ "-v", "-o=/home/user/output" });
+    bool p2 = (result && result.is_existing(verbose) && result.get(output) == "/home/user/output" && result.get(threads, 1) == 1);
+
+    return (p1 && p2);
+}
+
+bool test_11()
+{
+    xf::cmd::Parser parser(
+        { {{"-i", "--index"}, opt_t::make<unsigned int>(false, true, true)},
+          {{"-n", "--name"},  opt_t::make<std::string>(false, false, true, "[a-z]+")} });
+
+    auto frozen = parser.Freeze();
+    parser.RemoveOption({ "-i", "--index" });
+
+    xf::cmd::list_t<xf::cmd::list_t<std::string>> batch;
+    for (unsigned int i = 0; i < 1000; ++i)
+        batch.push_back({ "--index=" + std::to_string(i), "-n", (i % 7 ? "abc" : "ABC") });
+
+    auto results = frozen.ParseBatch(batch, 4);
+
+    bool ok = (batch.size() == results.size());
+    for (unsigned int i = 0; ok && i < results.size(); ++i)
+    {
+        if (i % 7)
+            ok = (results[i] && results[i].get<unsigned int>("-i") == i && results[i].get<std::string>("--name") == "abc");
+        else
+            ok = (xf::cmd::state_t::s_v_error == results[i].code() && results[i].hint().first == "-n");
+    }
+
+    // 不支持随机访问的容器
+    std::list<std::list<std::string>> linked;
+    for (unsigned int i = 0; i < 1000; ++i)
+        linked.push_back({ "-i", std::to_string(i) });
+
+    auto linked_results = frozen.ParseBatch(linked, 4);
+    for (unsigned int i = 0; ok && i < linked_results.size(); ++i)
+        ok = (linked_results[i] && linked_results[i].get<unsigned int>("-i") == i);
+
+    return (ok && linked.size() == linked_results.size() && frozen.ParseBatch(xf::cmd::list_t<xf::cmd::list_t<std::string>>()).empty()
+               && !parser.Parse({ "-i=1" }) && frozen.Parse({ "-i=1" }));
+}
+
+bool test_12()
+{
+    auto dir = std::filesystem::temp_directory_path();
+    std::string outer = (dir / "xf_cmd_outer.rsp").string();
+    std::string inner = (dir / "xf_cmd_inner.rsp").string();
+    std::string loop = (dir / "xf_cmd_loop.rsp").string();
+
+    std::ofstream(outer) << "--name 'John Smith' \\\n  -m \"say \\\"hi\\\"\" @" << inner << "\n";
+    std::ofstream(inner) << "--level=L2\t-p a\\ b\\\\c\n-e 'x'\"y\"z";
+    std::ofstream(loop) << "-d @" << loop;
+
+    xf::cmd::Parser parser(
+        { {{"-n", "--name"},    opt_t::make<std::string>(false, true, true)},
+          {{"-m", "--message"}, opt_t::make<std::string>(false, false, true)},
+          {{"-l", "--level"},   opt_t::make<std::string>(false, false, true, "L[1234]")},
+          {{"-p", "--path"},    opt_t::make<std::string>(false, false, true)},
+          {{"-e", "--extra"},   opt_t::make<std::string>(false, false, false)},
+          {{"-d", "--detail"},  opt_t::make<nullptr_t>(false, false)} });
+
+    std::string arg = "@" + outer;
+    auto result = parser.Parse({ arg });
+    Show(result);
+    bool p1 = (!result && xf::cmd::state_t::s_k_unrecognized == result.code());
+
+    parser.EnableResponseFile();
+
+    std::string_view args[] = { "-d", arg };
+    result = parser.ParseView(args, 2);
+    Show(result);
+    bool p2 = (result && result.get<std::string>("-n") == "John Smith" && result.get<std::string>("-m") == "say \"hi\""
+                      && result.get<std::string>("-l") == "L2" && result.get<std::string>("-p") == "a b\\c"
+                      && result.get<std::string>("-e") == "xyz" && result.is_existing("-d"));
+
+    std::string looping = "@" + loop;
+    result = parser.Parse({ looping });
+    Show(result);
+    bool p3 = (!result && xf::cmd::state_t::s_f_error == result.code() && result.hint().first == loop);
+
+    std::string missing = "@" + (dir / "xf_cmd_missing.rsp").string();
+    result = parser.Parse({ "-n", "x", missing });
+    Show(result);
+    bool p4 = (!result && xf::cmd::state_t::s_f_error == result.code());
+
+    std::filesystem::remove(outer);
+    std::filesystem::remove(inner);
+    std::filesystem::remove(loop);
+
+    return (p1 && p2 && p3 && p4);
+}
+
+bool test_13()
+{
+    xf::cmd::Parser parser(
+        { {{"-i", "--input"},   opt_t::make<std::string>(false, true, true)},
+          {{"-t", "--threads"}, opt_t::make<unsigned int>(false, false, true)},
+          {{"-d", "--detail"},  opt_t::make<nullptr_t>(false, false)} });
+
+    const std::string input("/home/user/workspace/project/input.txt");
+
+    // 上游为 null_memory_resource, 超出 buffer 或使用全局堆都会导致失败
+    char buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+    xf::cmd::result_t copied;
+    bool p1 = false, p2 = false;
+    try {
+        auto result = parser.Parse({ "--input", input, "-t=4", "-d" }, &arena);
+        p1 = (result && result.get<std::string>("-i") == input && result.get<unsigned int>("--threads") == 4
+                     && result.is_existing("-d") && std::search(buffer, buffer + sizeof(buffer), input.begin(), input.end()) != buffer + sizeof(buffer));
+
+        copied = result;
+
+        auto error = parser.Parse({ "-t", "4" }, &arena);
+        p2 = (xf::cmd::state_t::s_k_missing == error.code());
+    } catch (const std::bad_alloc&) {
+        return false;
+    }
+
+    arena.release();
+    std::fill(buffer, buffer + sizeof(buffer), '\0');
+
+    bool p3 = (copied && copied.get<std::string>("--input") == input && copied.get<unsigned int>("-t") == 4);
+
+    return (p1 && p2 && p3);
+}
+
+bool test_14()
+{
+    xf::cmd::handle_t<std::string> input;
+    xf::cmd::handle_t<int> threads;
+    xf::cmd::handle_t<std::string> name;
+
+    xf::cmd::Parser parser;
+    parser.AddOption({ {"-i", "--input"},   opt_t::make<std::string>(false, true, true) }, input)
+          .AddOption({ {"-t", "--threads"}, opt_t::make<int>(false, false, true) }, threads)
+          .AddOption({ {"-n", "--name"},    opt_t::make<std::string>(false, false, true, [](const std::string& v) {
+                            if (v.size() > 8) throw std::length_error("name is too long");
+                            return true; }) }, name);
+
+    std::string_view a1[] = { "-i", "/home/user/input", "--unknown-parameter-name", "-t=1" };
+    auto r1 = parser.ParseView(a1, 4);
+    bool p1 = (xf::cmd::state_t::s_k_unrecognized == r1.code() && 2 == r1.error_index() && 0 == r1.error_id()
+               && r1.hint().first == "--unknown-parameter-name"
+               && r1.info() == R"(error: unrecognized parameter "--unknown-parameter-name".)");
+
+    // 超出 int 范围的值不会抛出异常
+    std::string_view a2[] = { "-i=x", "--threads", "99999999999" };
+    auto r2 = parser.ParseView(a2, 3);
+    bool p2 = (xf::cmd::state_t::s_v_error == r2.code() && 2 == r2.error_index() && threads.id() == r2.error_id()
+               && r2.hint() == std::make_pair(std::string("--threads"), std::string("99999999999")));
+
+    // 校验函数抛出的异常被视为校验失败
+    auto r3 = parser.Parse({ "-i=x", "-n", "a-very-long-name" });
+    bool p3 = (xf::cmd::state_t::s_v_error == r3.code() && name.id() == r3.error_id() && 2 == r3.error_index());
+
+    auto r4 = parser.Parse({ "-t", "4" });
+    bool p4 = (xf::cmd::state_t::s_k_missing == r4.code() && xf::cmd::result_t::npos == r4.error_index() && input.id() == r4.error_id()
+               && r4.info() == R"(error: the parameter "--input" must be specified but not found.)");
+
+    auto r5 = parser.Parse({ "-i=x", "-t" });
+    bool p5 = (xf::cmd::state_t::s_v_missing == r5.code() && 1 == r5.error_index() && r5.hint().first == "-t");
+
+    auto r6 = parser.Parse({ "-i=x" });
+    bool p6 = (r6 && r6.info() == "ok" && xf::cmd::result_t::npos == r6.error_index() && 0 == r6.error_id());
+
+    // 借用模式下缺少参数的提示在解析器销毁或修改之后仍然有效
+    xf::cmd::result_t r7, r8, r9;
+    {
+        xf::cmd::Parser local;
+        local.AddOption({ {"--required-input-file"}, opt_t::make<std::string>(false, true, true) })
+             .AddOption({ {"--output-directory"},    opt_t::make<std::string>(false, false, true) })
+             .AddOption({ {"--compression-level"},   opt_t::make<int>(false, false, true) })
+             .AddRequires("--compression-level", { "--output-directory" });
+
+        std::string_view a7[] = { "--compression-level=3" };
+        std::string_view a9[] = { "--required-input-file=x", "--compression-level=3" };
+        r7 = local.ParseView(a7, 1);
+        r9 = local.ParseView(a9, 2);
+        local.RemoveOption({ "--output-directory" });
+        r8 = local.ParseView(a7, 1);
+        local.RemoveOption({ "--required-input-file", "--compression-level" });
+    }
+
+    bool p7 = (xf::cmd::state_t::s_k_missing == r7.code() && r7.info() == R"(error: the parameter "--required-input-file" must be specified but not found.)"
+               && r8.hint().first == "--required-input-file"
+               && xf::cmd::state_t::s_k_missing == r9.code() && r9.hint() == std::make_pair(std::string("--output-directory"), std::string("--compression-level")));
+
+    return (p1 && p2 && p3 && p4 && p5 && p6 && p7);
+}
+
+struct config_t
+{
+    std::string input;
+    unsigned int threads{ 1 };
+    double ratio{ 0.5 };
+    int level{ 0 };
+    bool verbose{ false };
+    bool color{ false };
+};
+
+bool test_15()
+{
+    xf::cmd::Parser parser;
+    parser.Bind(&config_t::input, { "-i", "--input" }, false, true, true)
+          .Bind(&config_t::threads, { "-t", "--threads" })
+          .Bind(&config_t::ratio, { "-r", "--ratio" })
+          .Bind(&config_t::level, { "-l", "--level" }, opt_t::make<int>(false, false, true, "[0-3]"))
+          .Bind(&config_t::verbose, { "-v", "--verbose" }, opt_t::make<nullptr_t>(false, false))
+          .Bind(&config_t::color, { "-c", "--color" }, false, false, false)
+          .AddOption({ {"-o", "--output"}, opt_t::make<std::string>(false, false, true) });
+
+    const xf::cmd::list_t<std::string> args{ "-i", "/home/user/input", "--threads=8", "-v", "-c", "--level", "2", "-o", "/home/user/output" };
+
+    config_t cfg;
+    auto r1 = parser.ParseInto(args, cfg);
+    bool p1 = (r1 && cfg.input == "/home/user/input" && 8 == cfg.threads && 0.5 == cfg.ratio && 2 == cfg.level && cfg.verbose && cfg.color
+                  && r1.get<std::string>("--output") == "/home/user/output" && r1.is_existing("-t") && !r1.has_value("-t"));
+
+    // 未使用 ParseInto 时绑定的参数与普通参数一样保存在结果中
+    auto r2 = parser.Parse(args);
+    bool p2 = (r2 && r2.get<unsigned int>("-t") == 8 && r2.get<std::string>("-i") == "/home/user/input" && r2.is_existing("--color"));
+
+    config_t c3;
+    auto r3 = parser.ParseInto({ "-i=x", "-l=7" }, c3);
+    auto r4 = parser.ParseInto({ "-i=x", "-t", "-1" }, c3);
+    bool p3 = (xf::cmd::state_t::s_v_error == r3.code() && xf::cmd::state_t::s_v_error == r4.code() && 1 == c3.threads && 0 == c3.level);
+
+    // 目标类型与绑定的类型不同时参数保存在结果中
+    struct other_t { unsigned int threads{ 0 }; } other;
+    auto r5 = parser.ParseInto({ "-i=x", "-t", "4" }, other);
+    bool p5 = (r5 && 0 == other.threads && r5.get<unsigned int>("-t") == 4);
+
+    return (p1 && p2 && p3 && p5);
+}
+
+bool test_16()
+{
+    xf::cmd::handle_t<std::string> include;
+    xf::cmd::handle_t<int> level;
+
+    xf::cmd::Parser parser;
+    parser.AddOption({ {"-I", "--include"}, opt_t::make<std::string>(false, false, true).multiple() }, include)
+          .AddOption({ {"-l", "--level"},   opt_t::make<int>(false, false, true, "-?[0-9]").multiple(',') }, level)
+          .AddOption({ {"-f", "--flag"},    opt_t::make<bool>(false, false, true).multiple(':') })
+          .AddOption({ {"-v", "--verbose"}, opt_t::make<nullptr_t>(false, false).multiple() })
+          .AddOption({ {"-o", "--output"},  opt_t::make<std::string>(false, false, true) });
+
+    auto r1 = parser.Parse({ "-I", "/usr/include", "-l=1,-2,3", "--include=/usr/local/include", "-v", "-v", "-I", "a,b", "-l", "4", "-f", "true:false:True" });
+    auto dirs = r1.get_list(include);
+    auto levels = r1.get_list<int>("--level");
+    auto flags = r1.get_list<bool>("-f");
+    bool p1 = (r1 && 3 == dirs.size() && "/usr/include" == dirs[0] && "/usr/local/include" == dirs[1] && "a,b" == dirs.back()
+                  && 4 == levels.size() && -2 == levels[1] && 4 == levels.back()
+                  && 3 == flags.size() && flags[0] && !flags[1] && flags[2]
+                  && r1.is_existing("-v") && !r1.has_value("-v") && r1.has_value(include) && r1.get_list<int>("-o").empty()
+                  && r1.args()["-l"] == "1,-2,3,4");
+
+    // 非借用模式下字符串复制到结果中, 复制结果后仍然有效
+    xf::cmd::result_t copied;
+    {
+        xf::cmd::list_t<std::string> args;
+        for (int i = 0; i < 10000; ++i)
+            args.push_back("--include=/home/user/workspace/project/include/" + std::to_string(i));
+
+        copied = parser.Parse(args);
+    }
+    auto all = copied.get_list(include);
+    bool p2 = (copied && 10000 == all.size() && "/home/user/workspace/project/include/0" == all.front() && "/home/user/workspace/project/include/9999" == all.back());
+
+    // 使用 arena 解析后复制, arena 释放后复制的结果中的列表仍然有效
+    {
+        char buffer[16384];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        {
+            auto result = parser.Parse({ "-I", std::string(64, 'a'), "-I", std::string(64, 'b') }, &arena);
+            copied = static_cast<const xf::cmd::result_t&>(result);
+        }
+        arena.release();
+        std::fill(buffer, buffer + sizeof(buffer), '\0');
+    }
+    auto arena_dirs = copied.get_list(include);
+    p2 = (p2 && 2 == arena_dirs.size() && std::string(64, 'a') == arena_dirs[0] && std::string(64, 'b') == arena_dirs[1]);
+
+    auto r3 = parser.Parse({ "-l", "1,22" });
+    auto r4 = parser.Parse({ "-o", "x", "-o", "y" });
+    auto r5 = parser.Parse({ "-I", "" });
+    bool p3 = (xf::cmd::state_t::s_v_error == r3.code() && xf::cmd::state_t::s_k_duplicated == r4.code() && xf::cmd::state_t::s_v_error == r5.code());
+
+    return (p1 && p2 && p3);
+}
+
+bool test_17()
+{
+    xf::cmd::Parser parser(
+        { {{"-i", "--input"},        opt_t::make<std::string>(false, true, true)},
+          {{"-t", "--threads"},      opt_t::make<unsigned int>(false, false, true)},
+          {{"-l", "--log-level"},    opt_t::make<int>(false, false, true)},
+          {{"-o", "--output"},       opt_t::make<std::string>(false, false, true)},
+          {{"-I", "--include"},      opt_t::make<std::string>(false, false, true).multiple()},
+          {{"-v", "--verbose"},      opt_t::make<nullptr_t>(false, false)},
+          {{"-h", "--help"},         opt_t::make<nullptr_t>(true, false)} });
+
+    SetEnv("XF_TEST_LOG_LEVEL", "3");
+    SetEnv("XF_TEST_VERBOSE", "1");
+    auto env = parser.GetEnvironmentArgs("XF_TEST_");
+    SetEnv("XF_TEST_LOG_LEVEL", nullptr);
+    SetEnv("XF_TEST_VERBOSE", nullptr);
+
+    // 默认值中被覆盖的错误值不会被校验
+    xf::cmd::list_t<std::string> defaults{ "--threads=abc", "--log-level", "1", "--output=/tmp/default", "-I", "/usr/include" };
+    xf::cmd::list_t<std::string> config{ "--input", "/home/user/config-input", "-I", "/opt/include", "-I", "/opt/local/include" };
+    xf::cmd::list_t<std::string> argv{ "--threads", "8", "-I", "./include" };
+
+    auto r1 = parser.ParseLayers({ defaults, config, env, argv });
+    bool p1 = (r1 && 2 == env.size() && r1.get<unsigned int>("-t") == 8 && 3 == r1.source("-t")
+                  && r1.get<int>("--log-level") == 3 && 2 == r1.source("-l") && r1.is_existing("-v") && 2 == r1.source("--verbose")
+                  && r1.get<std::string>("-o") == "/tmp/default" && 0 == r1.source("-o")
+                  && r1.get<std::string>("-i") == "/home/user/config-input" && 1 == r1.source("-i")
+                  && 1 == r1.get_list<std::string_view>("-I").size() && xf::cmd::result_t::npos == r1.source("-h"));
+
+    // 唯一的参数只在同一个来源中检查, 低优先级的来源被忽略
+    auto r2 = parser.ParseLayers({ defaults, { "-h" } });
+
+    auto r3 = parser.ParseLayers({ { "--threads=1" }, argv });
+    auto r4 = parser.ParseLayers({ defaults, { "-i", "x", "-o", "a", "-o", "b" }, argv });
+    bool p2 = (r2 && r2.is_existing("-h") && !r2.is_existing("-o")
+                  && xf::cmd::state_t::s_k_missing == r3.code()
+                  && xf::cmd::state_t::s_k_duplicated == r4.code() && 1 == r4.error_source() && 4 == r4.error_index());
+
+    return (p1 && p2);
+}
+
+bool test_18()
+{
+    xf::cmd::Parser parser(
+        { {{"-i", "--input"},   opt_t::make<std::string>(false, true, true)},
+          {{"-t", "--threads"}, opt_t::make<unsigned int>(false, false, true)},
+          {{"-l", "--level"},   opt_t::make<int>(false, false, false)},
+          {{"-f", "--format"},  opt_t::make<std::string>(false, false, true, "xml|json")},
+          {{"-v", "--verbose"}, opt_t::make<nullptr_t>(false, false)},
+          {{"-h", "--help"},    opt_t::make<nullptr_t>(true, false)} });
+
+    const char* pool[] = { "-i", "/home/user/input", "--input=x", "-t", "8", "--threads=abc", "-l", "-3", "--level=2", "-f", "json", "-f=yaml",
+                           "-v", "--verbose=1", "-h", "--unknown", "value" };
+    const unsigned int size = std::extent<decltype(pool)>::value;
+
+    auto same = [](const xf::cmd::result_t& a, const xf::cmd::result_t& b) {
+        return (a.code() == b.code() && a.info() == b.info() && a.error_index() == b.error_index()
+                && a.error_id() == b.error_id() && a.args() == b.args());
+    };
+
+    // 随机修改上一次的参数, Reparse 的结果必须与完整解析相同
+    unsigned int seed = 12345;
+    auto rand = [&seed]() { seed = seed * 1103515245 + 12345; return (seed >> 16) & 0x7fff; };
+
+    bool p1 = true;
+    xf::cmd::list_t<std::string> args{ "-i", "/home/user/input", "-t", "8", "-v" };
+    xf::cmd::result_t previous = parser.Reparse(xf::cmd::result_t(), args);
+    for (int i = 0; p1 && i < 5000; ++i)
+    {
+        switch (rand() % 4)
+        {
+        case 0: if (!args.empty()) args[rand() % args.size()] = pool[rand() % size]; break;
+        case 1: args.insert(args.begin() + (args.empty() ? 0 : rand() % (args.size() + 1)), pool[rand() % size]); break;
+        case 2: if (!args.empty()) args.erase(args.begin() + rand() % args.size()); break;
+        default: if (8 < args.size()) args.resize(4); break;
+        }
+
+        auto result = parser.Reparse(previous, args);
+        p1 = same(result, parser.Parse(args));
+        previous = result;
+    }
+
+    // 只修改一个值
+    auto r1 = parser.Reparse(xf::cmd::result_t(), { "-i", "/home/user/input", "-t", "8", "-l", "-v", "-f", "xml" });
+    auto r2 = parser.Reparse(r1, { "-i", "/home/user/input", "-t", "16", "-l", "-v", "-f", "xml" });
+    auto r3 = parser.Reparse(r2, { "-i", "/home/user/input", "-t", "16", "-l", "-v", "-t", "4" });
+    bool p2 = (r2 && r2.get<unsigned int>("-t") == 16 && r2.get<std::string>("-f") == "xml" && r2.is_existing("-v") && !r2.has_value("-l")
+                  && xf::cmd::state_t::s_k_duplicated == r3.code() && 6 == r3.error_index());
+
+    // 两次 Reparse 之间添加约束, 参数相同也要重新检查
+    xf::cmd::list_t<std::string> same_args{ "-i", "/home/user/input", "-t", "8", "-v" };
+    auto r4 = parser.Reparse(xf::cmd::result_t(), same_args);
+    parser.AddExclusive({ "-t", "-v" });
+    auto r5 = parser.Reparse(r4, same_args);
+    parser.AddRequires("-i", { "-f" });
+    auto r6 = parser.Reparse(r5, { "-i", "/home/user/input", "-v" });
+    auto r7 = parser.Reparse(r6, { "-i", "/home/user/input", "-v" });
+    bool p3 = (r4 && xf::cmd::state_t::s_k_conflict == r5.code() && same(r5, parser.Parse(same_args))
+                  && xf::cmd::state_t::s_k_missing == r6.code() && same(r6, r7));
+
+    return (p1 && p2 && p3);
+}
+
+struct endpoint_t { unsigned char ip[4]{}; unsigned short port{ 0 }; };
+enum class run_mode_t { fast, safe };
+struct tags_t { std::vector<std::string> names; };
+
+template<> struct xf::cmd::converter_t<endpoint_t>
+{
+    // a.b.c.d:port
+    static bool from_string(std::string_view v, endpoint_t& x)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            auto n = v.find(i < 3 ? '.' : ':');
+            if (std::string_view::npos == n || !xf::cmd::converter_t<unsigned char>::from_string(v.substr(0, n), x.ip[i])) return false;
+            v.remove_prefix(n + 1);
+        }
+        return xf::cmd::converter_t<unsigned short>::from_string(v, x.port);
+    }
+
+    static std::string to_string(const endpoint_t& x)
+    {
+        return std::to_string(x.ip[0]) + "." + std::to_string(x.ip[1]) + "." + std::to_string(x.ip[2]) + "." + std::to_string(x.ip[3]) + ":" + std::to_string(x.port);
+    }
+};
+
+template<> struct xf::cmd::converter_t<run_mode_t>
+{
+    static bool from_string(std::string_view v, run_mode_t& x)
+    {
+        if ("fast" == v) { x = run_mode_t::fast; return true; }
+        if ("safe" == v) { x = run_mode_t::safe; return true; }
+        if ("boom" == v) throw std::runtime_error("unexpected mode");
+        return false;
+    }
+};
+
+template<> struct xf::cmd::converter_t<tags_t>
+{
+    static bool from_string(std::string_view v, tags_t& x)
+    {
+        for (size_t i = 0; i <= v.size(); )
+        {
+            size_t j = std::min(v.find('+', i), v.size());
+            if (i == j) return false;
+            x.names.emplace_back(v.substr(i, j - i));
+            i = j + 1;
+        }
+        return true;
+    }
+};
+
+struct limits_t { std::int64_t offset{ 0 }; endpoint_t server; run_mode_t mode{ run_mode_t::fast }; };
+
+bool test_19()
+{
+    xf::cmd::Parser parser;
+    parser.AddOption({ {"-s", "--size"},   opt_t::make<std::uint64_t>(false, false, true) })
+          .AddOption({ {"-d", "--delta"},  opt_t::make<std::int64_t>(false, false, true) })
+          .AddOption({ {"-g", "--gain"},   opt_t::make<float>(false, false, true) })
+          .AddOption({ {"-m", "--mode"},   opt_t::make<run_mode_t>(false, false, true) })
+          .AddOption({ {"-t", "--tags"},   opt_t::make<tags_t>(false, false, true) })
+          .Bind(&limits_t::offset, { "-o", "--offset" })
+          .Bind(&limits_t::server, { "-e", "--endpoint" })
+          .Bind(&limits_t::mode, { "--limit-mode" });
+
+    auto r1 = parser.Parse({ "-s", "18446744073709551615", "-d=-9223372036854775808", "-g", "0.5", "-m", "safe", "-t", "a+bc+d", "-e", "10.0.0.1:8080" });
+    auto tags = r1.get<tags_t>("--tags");
+    bool p1 = (r1 && r1.get<std::uint64_t>("-s") == UINT64_MAX && r1.get<std::int64_t>("--delta") == INT64_MIN && r1.get<float>("-g") == 0.5f
+                  && r1.get<run_mode_t>("-m") == run_mode_t::safe && 3 == tags.names.size() && "bc" == tags.names[1]
+                  && 10 == r1.get<endpoint_t>("-e").ip[0] && 8080 == r1.get<endpoint_t>("-e").port
+                  && r1.args()["-e"] == "10.0.0.1:8080" && r1.args()["-m"].empty());
+
+    // 类型不匹配时与内置类型一样抛出异常
+    bool p2 = false;
+    try { r1.get<std::int64_t>("-s"); } catch (const std::bad_variant_access&) { p2 = true; }
+
+    // 结果复制后自定义类型的值仍然有效
+    xf::cmd::result_t copied = r1;
+    r1 = xf::cmd::result_t();
+    p2 = (p2 && copied.get<tags_t>("-t").names.back() == "d" && copied.get("-m", run_mode_t::fast) == run_mode_t::safe);
+
+    auto r3 = parser.Parse({ "-s", "18446744073709551616" });
+    auto r4 = parser.Parse({ "-d", "9223372036854775808" });
+    auto r5 = parser.Parse({ "-e", "10.0.0.256:80" });
+    auto r6 = parser.Parse({ "-m", "slow" });
+    auto r7 = parser.Parse({ "-t", "a++b" });
+    bool p3 = (xf::cmd::state_t::s_v_error == r3.code() && xf::cmd::state_t::s_v_error == r4.code() && xf::cmd::state_t::s_v_error == r5.code()
+                  && xf::cmd::state_t::s_v_error == r6.code() && xf::cmd::state_t::s_v_error == r7.code());
+
+    limits_t lim;
+    auto r8 = parser.ParseInto({ "-o", "-5000000000", "--endpoint=127.0.0.1:1" }, lim);
+    bool p4 = (r8 && -5000000000LL == lim.offset && 127 == lim.server.ip[0] && 1 == lim.server.port);
+
+    // 自定义类型的值不能重复, 定义参数时即报错
+    bool rejected = false;
+    try { opt_t::make<std::int64_t>(false, false, true).multiple(); } catch (const std::invalid_argument&) { rejected = true; }
+
+    // 转换函数抛出异常时视为转换失败, 不会从 Parse 中抛出
+    bool p5 = rejected;
+    try {
+        auto r9 = parser.Parse({ "-m", "boom" });
+        auto r10 = parser.ParseInto({ "--limit-mode=boom" }, lim);
+        auto r11 = parser.ParseInto({ "--limit-mode=safe" }, lim);
+        p5 = (p5 && xf::cmd::state_t::s_v_error == r9.code() && xf::cmd::state_t::s_v_error == r10.code() && !parser.GetOption("-m")->check("boom")
+                 && r11 && run_mode_t::safe == lim.mode);
+    } catch (...) {
+    }
+
+    return (p1 && p2 && p3 && p4 && p5);
+}
+
+bool test_20()
+{
+    int built[3]{ 0, 0, 0 };
+
+    xf::cmd::Parser parser;
+    parser.AddOption({ {"-C"}, opt_t::make<std::string>(false, false, true) })
+          .AddOption({ {"-v", "--verbose"}, opt_t::make<bool>(false, false, false) })
+          .AddCommand("commit", [&](xf::cmd::Parser& p) {
+              ++built[0];
+              p.AddOption({ {"-m", "--message"}, opt_t::make<std::string>(false, true, true) })
+               .Bind(&config_t::verbose, { "--amend" }, opt_t::make<nullptr_t>(false, false));
+          })
+          .AddCommand("push", [&](xf::cmd::Parser& p) {
+              ++built[1];
+              p.AddOption({ {"-r", "--remote"}, opt_t::make<std::string>(false, true, true) });
+          })
+          .AddCommand("remote", [&](xf::cmd::Parser& p) {
+              ++built[2];
+              p.AddCommand("add", [](xf::cmd::Parser& q) { q.AddOption({ {"-f"}, opt_t::make<nullptr_t>(false, false) }); });
+          });
+
+    // 只构造选中的子命令, 之后复用
+    auto r1 = parser.Parse({ "-C", "/home/user/repo", "commit", "-m", "fix" });
+    auto r2 = parser.Parse({ "-v", "commit", "--message=again" });
+    bool p1 = (r1 && r1.command() == "commit" && r1.get<std::string>("-C") == "/home/user/repo" && r1.command_result().get<std::string>("-m") == "fix"
+                  && !r1.command_result().is_existing("--amend") && r2 && r2.is_existing("-v") && !r2.has_value("-v") && r2.command() == "commit"
+                  && 1 == built[0] && 0 == built[1] && 0 == built[2]);
+
+    auto r3 = parser.Parse({ "-v" });
+    auto r4 = parser.Parse({ "remote", "add", "-f" });
+    bool p2 = (r3 && r3.command().empty() && xf::cmd::state_t::s_nothing == r3.command_result().code()
+                  && r4 && r4.command_result().command() == "add" && r4.command_result().command_result().is_existing("-f") && 1 == built[2]);
+
+    // 使用 arena 解析, arena 释放后子命令的结果仍然有效
+    xf::cmd::result_t copied;
+    {
+        char buffer[16384];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        {
+            auto result = parser.Parse({ "-v", "remote", "add", "-f" }, &arena);
+            copied = static_cast<const xf::cmd::result_t&>(result);
+        }
+        arena.release();
+        std::fill(buffer, buffer + sizeof(buffer), '\0');
+    }
+    p2 = (p2 && copied && copied.command() == "remote" && copied.command_result().command() == "add" && copied.command_result().command_result().is_existing("-f"));
+
+    // 子命令中的错误, 位置对应全部参数
+    auto r5 = parser.Parse({ "-C", "x", "commit", "-m", "fix", "-x" });
+    auto r6 = parser.Parse({ "push" });
+    auto r7 = parser.Parse({ "commit", "-m", "fix", "-C", "x" });
+    auto r8 = parser.Parse({ "pull" });
+    auto r9 = parser.Parse({ "commit", "-m", "fix", "push" });
+    bool p3 = (xf::cmd::state_t::s_k_unrecognized == r5.code() && 5 == r5.error_index() && r5.command() == "commit"
+                  && xf::cmd::state_t::s_k_missing == r6.code() && xf::cmd::result_t::npos == r6.error_index() && 1 == built[1]
+                  && xf::cmd::state_t::s_k_unrecognized == r7.code() && 3 == r7.error_index()
+                  && xf::cmd::state_t::s_k_unrecognized == r8.code() && xf::cmd::state_t::s_k_unrecognized == r9.code());
+
+    // 子命令中绑定的参数同样直接写入结构体
+    config_t cfg;
+    auto r10 = parser.ParseInto({ "commit", "--amend", "-m", "x" }, cfg);
+    bool p4 = (r10 && cfg.verbose && nullptr != parser.GetCommand("push") && nullptr == parser.GetCommand("pull") && 3 == parser.GetCommands().size());
+
+    return (p1 && p2 && p3 && p4);
+}
+
+bool test_21()
+{
+    xf::cmd::Parser parser;
+    parser.AddOption({ {"-i", "--input"}, opt_t::make<std::string>(false, false, true) })
+          .AddOption({ {"-l", "--level"}, opt_t::make<int>(false, false, true) })
+          .AddOption({ {"-D", "--define"}, opt_t::make<std::string>(false, false, true).multiple() })
+          .AddOption({ {"-v", "--verbose"}, opt_t::make<nullptr_t>(false, false) });
+
+    std::string line(R"(  --input "/home/user/my documents/a \"b\".txt"	-l=-3 -D 'x y' -D a\ b\\c -D="q"uo'te'd -D "\$HOME\n" --verbose )");
+    auto r1 = parser.ParseCommandLine(line);
+    auto defines = r1.get_list<std::string_view>("-D");
+    bool p1 = (r1 && r1.get<std::string>("-i") == R"(/home/user/my documents/a "b".txt)" && -3 == r1.get<int>("--level") && r1.is_existing("-v")
+                  && 4 == defines.size() && "x y" == defines[0] && R"(a b\c)" == defines[1] && "quoted" == defines[2] && R"($HOME\n)" == defines[3]);
+
+    // 随机生成参数, 以不同的方式加上引号和转义后拼接, 结果与直接解析参数列表相同
+    std::mt19937 rng(20261018);
+    const std::string chars("abcdefghijklmnopqrstuvwxyz0123456789 \t'\"\\$=-_/.");
+    bool p2 = true;
+    for (int round = 0; round < 500 && p2; ++round)
+    {
+        xf::cmd::list_t<std::string> args;
+        std::string command;
+        for (int i = 0, n = int(rng() % 8); i < n; ++i)
+        {
+            std::string value;
+            for (int j = 0, m = 1 + int(rng() % 40); j < m; ++j)
+                value += chars[rng() % chars.size()];
+
+            std::string quoted;
+            switch (rng() % 3)
+            {
+            case 0:
+                for (char c : value) { if (std::string(" \t'\"\\$").find(c) != std::string::npos) quoted += '\\'; quoted += c; }
+                break;
+            case 1:
+                quoted = "'";
+                for (char c : value) quoted += ('\'' == c ? std::string(R"('\'')") : std::string(1, c));
+                quoted += "'";
+                break;
+            default:
+                quoted = "\"";
+                for (char c : value) { if (std::string("\"\\$`").find(c) != std::string::npos) quoted += '\\'; quoted += c; }
+                quoted += "\"";
+                break;
+            }
+
+            args.push_back("-D");
+            args.push_back(value);
+            command += std::string(1 + rng() % 3, ' ') + "-D " + quoted;
+        }
+
+        auto expected = parser.Parse(args);
+        auto actual = parser.ParseCommandLine(command);
+        p2 = (expected.code() == actual.code() && expected.args() == actual.args());
+    }
+
+    auto r3 = parser.ParseCommandLine("-i 'a b' --unknown");
+    auto r4 = parser.ParseCommandLine(" \t ");
+    bool p3 = (xf::cmd::state_t::s_k_unrecognized == r3.code() && 2 == r3.error_index() && r3.hint().first == "--unknown"
+                  && xf::cmd::state_t::s_nothing == r4.code());
+
+    return (p1 && p2 && p3);
+}
+
+bool test_22()
+{
+    std::atomic<int> calls{ 0 };
+
+    xf::cmd::Parser parser;
+    parser.AddOption({ {"-i", "--input"}, opt_t::make<std::string>(false, true, true) })
+          .AddOption({ {"-l", "--level"}, opt_t::make<int>(false, false, true, "[0-3]") })
+          .AddOption({ {"-t", "--threads"}, opt_t::make<unsigned int>(false, false, true) })
+          .EnableMetrics(true, true, [&](xf::cmd::state_t, std::chrono::nanoseconds) { ++calls; });
+
+    parser.Parse({ "-i", "a", "-l", "2", "--threads=4" });
+    parser.Parse({ "-i", "b", "-l=7" });
+    parser.Parse({ "-i", "c", "-t", "-1" });
+    parser.Parse({ "-l", "1" });
+    parser.Parse({ "--unknown" });
+    parser.Parse(xf::cmd::list_t<std::string>());
+
+    auto m = parser.GetMetrics();
+    auto find = [](const xf::cmd::metrics_t& m, const std::string& key) {
+        for (auto& opt : m.options) if (opt.keys.count(key)) return opt;
+        return xf::cmd::metrics_t::option_stats_t();
+    };
+
+    std::uint64_t histogram = 0;
+    for (auto n : m.latency) histogram += n;
+
+    using s_t = xf::cmd::state_t;
+    bool p1 = (6 == m.parses && 1 == m.states[s_t::s_ok] && 2 == m.states[s_t::s_v_error] && 1 == m.states[s_t::s_k_missing]
+                  && 1 == m.states[s_t::s_k_unrecognized] && 1 == m.states[s_t::s_nothing] && 6 == histogram && 6 == calls
+                  && 3 == m.options.size() && 3 == find(m, "-i").hits && 0 == find(m, "-i").failures
+                  && 3 == find(m, "--level").hits && 1 == find(m, "--level").failures && 2 == find(m, "-t").hits && 1 == find(m, "-t").failures
+                  && m.match_ns + m.check_ns + m.convert_ns <= m.total_ns);
+
+    // FrozenParser 共享统计, 多个线程同时更新
+    xf::cmd::FrozenParser frozen(parser);
+    parser.ResetMetrics();
+    xf::cmd::list_t<xf::cmd::list_t<std::string>> batch(1000, xf::cmd::list_t<std::string>{ "-i", "x", "-t", "8" });
+    frozen.ParseBatch(batch, 4);
+    auto m2 = frozen.GetMetrics();
+    bool p2 = (1000 == m2.parses && 1000 == m2.states[s_t::s_ok] && 1006 == calls);
+
+    // 只计数不计时, 关闭后没有统计
+    parser.EnableMetrics(true);
+    parser.Parse({ "-i", "a" });
+    auto m3 = parser.GetMetrics();
+    parser.EnableMetrics(false);
+    parser.Parse({ "-i", "a" });
+    bool p3 = (1 == m3.parses && 0 == m3.total_ns && 1 == find(m3, "-i").hits && 0 == parser.GetMetrics().parses && parser.GetMetrics().options.empty());
+
+    // 开启统计之后添加的参数同样计数, 复制的解析器共享
+    parser.EnableMetrics(true);
+    for (int i = 0; i < 200; ++i)
+        parser.AddOption({ {"--late-" + std::to_string(i)}, opt_t::make<int>(false, false, true) });
+
+    xf::cmd::Parser copied(parser);
+    parser.Parse({ "-i", "a", "--late-0=1", "--late-199=2" });
+    copied.Parse({ "-i", "b", "--late-199=x" });
+    auto m4 = parser.GetMetrics();
+    bool p4 = (203 == m4.options.size() && 2 == find(m4, "-i").hits && 1 == find(m4, "--late-0").hits
+                  && 2 == find(m4, "--late-199").hits && 1 == find(m4, "--late-199").failures && 0 == find(m4, "--late-100").hits);
+
+    return (p1 && p2 && p3 && p4);
+}
+
+bool test_23()
+{
+    xf::cmd::SharedParser parser(xf::cmd::Parser({ {{"-b", "--base"}, opt_t::make<int>(false, false, true)} }));
+
+    auto first = parser.Snapshot();
+    auto r0 = parser.Parse({ "--base", "1" });
+
+    // 解析线程与修改参数表同时进行
+    std::atomic<bool> done{ false };
+    std::atomic<int> errors{ 0 };
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t)
+    {
+        readers.emplace_back([&, t]() {
+            for (int i = 0; !done || i < 100; ++i)
+            {
+                auto snapshot = parser.Snapshot();
+                auto r = snapshot->Parse({ "-b", std::to_string(i) });
+                // 同一个快照中新增的参数要么都可见, 要么都不可见
+                auto r1 = snapshot->Parse({ "--plugin-" + std::to_string(t) + "=x" });
+                auto r2 = snapshot->Parse({ "--plugin-" + std::to_string(t) + "=x" });
+                if (!r || r.get<int>("--base") != i || r1.code() != r2.code())
+                    ++errors;
+            }
+        });
+    }
+
+    for (int i = 0; i < 200; ++i)
+    {
+        parser.AddOption({ {"--plugin-" + std::to_string(i)}, opt_t::make<std::string>(false, false, true) });
+        if (0 == i % 3)
+            parser.RemoveOption({ "--plugin-" + std::to_string(i) });
+    }
+
+    done = true;
+    for (auto& t : readers)
+        t.join();
+
+    parser.Update([](xf::cmd::Parser& p) {
+        p.AddOption({ {"-x"}, opt_t::make<nullptr_t>(false, false) }).AddOption({ {"-y"}, opt_t::make<nullptr_t>(false, false) });
+    });
+
+    auto r1 = parser.Parse({ "--plugin-1=a", "--plugin-199=b", "-x", "-y" });
+    auto r2 = parser.Parse({ "--plugin-3=a" });
+    auto r3 = first->Parse({ "--plugin-1=a" });
+    bool p1 = (0 == errors && r0 && r0.get<int>("-b") == 1 && r1 && r1.get<std::string>("--plugin-199") == "b"
+                  && xf::cmd::state_t::s_k_unrecognized == r2.code() && xf::cmd::state_t::s_k_unrecognized == r3.code());
+
+    return p1;
+}
+
+bool test_24()
+{
+    xf::cmd::Parser parser;
+    parser.AddOption({ {"-i", "--input"}, opt_t::make<std::string>(false, true, true) })
+          .AddOption({ {"-j", "--json"}, opt_t::make<nullptr_t>(false, false) })
+          .AddOption({ {"-x", "--xml"}, opt_t::make<nullptr_t>(false, false) })
+          .AddOption({ {"-y", "--yaml"}, opt_t::make<nullptr_t>(false, false) })
+          .AddOption({ {"-u", "--user"}, opt_t::make<std::string>(false, false, true) })
+          .AddOption({ {"-p", "--password"}, opt_t::make<std::string>(false, false, true) })
+          .AddOption({ {"-h", "--help"}, opt_t::make<nullptr_t>(true, false) })
+          .AddExclusive({ "--json", "--xml", "-y" })
+          .AddAtLeastOne({ "-j", "-x", "-y" })
+          .AddRequires("--user", { "--password" })
+          .AddExclusive({ "--not-exist" });
+
+    using s_t = xf::cmd::state_t;
+
+    auto r1 = parser.Parse({ "-i", "a", "--xml" });
+    auto r2 = parser.Parse({ "-i", "a", "--user", "root", "-p", "pwd", "-y" });
+    auto r3 = parser.Parse({ "-h" });
+    bool p1 = (r1 && r2 && r3);
+
+    auto r4 = parser.Parse({ "-i", "a", "--xml", "-j" });
+    auto r5 = parser.Parse({ "-i", "a" });
+    auto r6 = parser.Parse({ "-i", "a", "-x", "-u", "root" });
+    auto r7 = parser.Parse({ "-x" });
+    bool p2 = (s_t::s_k_conflict == r4.code() && r4.hint().first == "--xml" && r4.hint().second == "-j" && r4.error_id() == parser.GetHandle<nullptr_t>("-x").id()
+                  && s_t::s_k_missing == r5.code() && r5.hint().first == "--json"
+                  && s_t::s_k_missing == r6.code() && r6.hint().first == "--password" && r6.hint().second == "-u"
+                  && r6.info() == R"(error: the parameter "--password" must be specified with "-u".)"
+                  && s_t::s_k_missing == r7.code() && r7.hint().first == "--input");
+
+    // 删除参数后约束中不再包含该参数, 依赖其他参数的参数被删除时约束一起删除
+    parser.RemoveOption({ "-y", "--yaml" });
+    parser.RemoveOption({ "-u", "--user" });
+    auto r8 = parser.Parse({ "-i", "a", "-j" });
+    auto r9 = parser.Parse({ "-i", "a", "-p", "pwd", "-x" });
+    bool p3 = (r8 && r9);
+
+    return (p1 && p2 && p3);
+}
+
+bool test_25()
+{
+    using list_t = std::vector<std::string>;
+
+    xf::cmd::Parser parser;
+    parser.AddOption({ {"-f", "--format"}, opt_t(v_t::vt_string, true, false, true, std::string("xml|json|edn")) })
+          .AddOption({ {"-l", "--level"}, opt_t(v_t::vt_string, false, false, false, std::string("L[1-3]")) })
+          .AddOption({ {"-r", "--repeat"}, opt_t(v_t::vt_string, true, false, true, std::string("(ab)+")) })
+          .AddOption({ {"-d", "--debug"}, opt_t::make<bool>(true, false, true) })
+          .AddOption({ {"--force"}, opt_t::make<nullptr_t>(true, false) })
+          .AddOption({ {"--file"}, opt_t::make<std::string>(true, false, true) })
+          .AddCommand("fetch", [](xf::cmd::Parser& p) {
+              p.AddOption({ {"--depth"}, opt_t::make<int>(true, false, true) })
+               .AddOption({ {"--mode"}, opt_t(v_t::vt_string, true, false, true, std::string("fast|full")) });
+          })
+          .AddCommand("format", [](xf::cmd::Parser&) { });
+
+    // 参数名和子命令按字典序, 只返回以 token 开头的
+    bool p1 = (parser.Complete({}, "--f") == list_t{ "--file", "--force", "--format" }
+               && parser.Complete({}, "f") == list_t{ "fetch", "format" }
+               && parser.Complete({}, "--fo", 1) == list_t{ "--force" }
+               && parser.Complete({}, "--x").empty());
+
+    // 值: 有限的模式、布尔类型、key=value 的形式, 无限的模式和任意字符串没有候选
+    bool p2 = (parser.Complete({ "-f" }, "") == list_t{ "edn", "json", "xml" }
+               && parser.Complete({ "--force", "--format" }, "j") == list_t{ "json" }
+               && parser.Complete({}, "--format=x") == list_t{ "--format=xml" }
+               && parser.Complete({ "-d" }, "") == list_t{ "false", "true" }
+               && parser.Complete({ "-r" }, "ab").empty()
+               && parser.Complete({ "--file" }, "-").empty()
+               && parser.Complete({ "-f", "json" }, "--fi") == list_t{ "--file" });
+
+    // 值可以省略的参数之后同时补全值和参数名
+    bool p3 = (parser.Complete({ "-l" }, "").size() == 3 + 10 + 2
+               && parser.Complete({ "-l" }, "-l") == list_t{ "-l" }
+               && parser.Complete({ "--level" }, "L") == list_t{ "L1", "L2", "L3" });
+
+    // 子命令之后由子命令的解析器补全
+    bool p4 = (parser.Complete({ "-f", "xml", "fetch" }, "--") == list_t{ "--depth", "--mode" }
+               && parser.Complete({ "fetch", "--depth", "3", "--mode" }, "f") == list_t{ "fast", "full" }
+               && parser.Complete({ "format" }, "--f").empty());
+
+    // 删除的参数不再出现, FrozenParser 与 Parser 相同
+    parser.RemoveOption({ "--force" });
+    bool p5 = (parser.Complete({}, "--f") == list_t{ "--file", "--format" }
+               && parser.Freeze().Complete({ "-f" }, "x") == list_t{ "xml" });
+
+    return (p1 && p2 && p3 && p4 && p5);
+}
+
+bool test_26()
+{
+    xf::cmd::Parser parser;
+    parser.AddOption({ {"-b", "--bool"}, opt_t::make<bool>(false, false, true) })
+          .AddOption({ {"-i", "--int"}, opt_t::make<int>(false, false, true) })
+          .AddOption({ {"-u", "--unsigned"}, opt_t::make<unsigned int>(false, false, true) })
+          .AddOption({ {"-f", "--float"}, opt_t::make<double>(false, false, true) })
+          .AddOption({ {"-s", "--string"}, opt_t::make<std::string>(false, false, true) })
+          .AddOption({ {"-o", "--optional"}, opt_t::make<std::string>(false, false, false) })
+          .AddOption({ {"-n", "--nothing"}, opt_t::make<nullptr_t>(false, false) })
+          .AddOption({ {"-I", "--include"}, opt_t::make<std::string>(false, false, true).multiple() })
+          .AddOption({ {"-D", "--define"}, opt_t::make<int>(false, false, true).multiple(',') })
+          .AddOption({ {"-F", "--flag"}, opt_t::make<bool>(false, false, true).multiple(',') })
+          .AddOption({ {"-S", "--size"}, opt_t::make<std::uint64_t>(false, false, true) })
+          .AddOption({ {"-e", "--endpoint"}, opt_t::make<endpoint_t>(false, false, true) })
+          .AddOption({ {"-x"}, opt_t::make<int>(false, false, true) })
+          .AddCommand("run", [](xf::cmd::Parser& p) {
+              p.AddOption({ {"-j", "--jobs"}, opt_t::make<unsigned int>(false, false, true) })
+               .AddOption({ {"-t", "--target"}, opt_t::make<std::string>(false, true, true) });
+          });
+
+    auto r = parser.Parse({ "-b", "true", "--int=-42", "-u", "4294967295", "-f", "0.1", "-s", "a \"quoted\" value", "-o", "-n",
+                            "-I", "/usr/include", "--include=/opt/include", "-D", "1,-2,3", "-F", "true,false,true",
+                            "-S", "18446744073709551615", "--endpoint=10.0.0.1:8080", "run", "-j", "8", "--target=all" });
+
+    // 复制字符串的结果在数据销毁后仍然有效, 借用的结果直接引用数据
+    std::string data = r.serialize();
+    auto args = r.args();
+    auto values = r.get();
+    auto copied = parser.Deserialize(data);
+    auto viewed = parser.DeserializeView(data);
+
+    auto same = [&](const xf::cmd::result_t& x) {
+        auto includes = x.get_list<std::string_view>("-I");
+        auto defines = x.get_list<int>("--define");
+        auto flags = x.get_list<bool>("-F");
+        return (x && x.get<bool>("-b") && x.get<int>("-i") == -42 && x.get<unsigned int>("-u") == 4294967295u && x.get<double>("-f") == 0.1
+                && x.get<std::string>("-s") == "a \"quoted\" value" && x.is_existing("-o") && !x.has_value("-o") && x.is_existing("-n") && !x.has_value("--nothing")
+                && 2 == includes.size() && "/opt/include" == includes[1] && 3 == defines.size() && -2 == defines[1]
+                && 3 == flags.size() && !flags[1] && x.get<std::uint64_t>("-S") == UINT64_MAX
+                && 8080 == x.get<endpoint_t>("-e").port && !x.is_existing("-x") && x.args() == args && x.get() == values
+                && x.command() == "run" && x.command_result().get<unsigned int>("--jobs") == 8 && x.command_result().get<std::string>("-t") == "all");
+    };
+
+    bool p1 = (same(viewed) && same(copied));
+
+    // 恢复到 arena 中的结果复制后, arena 释放不影响复制的结果
+    xf::cmd::result_t from_arena;
+    {
+        char buffer[16384];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        {
+            auto restored = parser.Deserialize(data, &arena);
+            from_arena = static_cast<const xf::cmd::result_t&>(restored);
+        }
+        arena.release();
+        std::fill(buffer, buffer + sizeof(buffer), '\0');
+    }
+
+    data.assign(data.size(), '\0');
+    r = xf::cmd::result_t();
+    bool p2 = (same(copied) && same(from_arena));
+
+    // 错误、没有参数的结果以及来源
+    auto e1 = parser.Parse({ "-n", "-i", "abc" });
+    auto e2 = parser.Deserialize(e1.serialize());
+    auto e3 = parser.Deserialize(parser.Parse(std::vector<std::string>()).serialize());
+    auto l1 = parser.ParseLayers({ { "-i=1", "-u=2" }, { "-i=3" } });
+    auto l2 = parser.DeserializeView(l1.serialize());
+    bool p3 = (e2.code() == e1.code() && e2.info() == e1.info() && e2.error_index() == 2 && e2.hint() == e1.hint() && e2.is_existing("-n")
+               && xf::cmd::state_t::s_nothing == e3.code() && !e3.is_existing("-n")
+               && 1 == l1.source("-i") && l2.source("-i") == 1 && l2.source("-u") == 0);
+
+    // 数据不完整或者参数表不同时抛出异常
+    auto rejected = [](auto func) {
+        try { func(); } catch (const std::invalid_argument&) { return true; }
+        return false;
+    };
+
+    // 没有 to_string 的自定义类型不能序列化
+    xf::cmd::Parser modes;
+    modes.AddOption({ {"-m", "--mode"}, opt_t::make<run_mode_t>(false, false, true) });
+    auto m1 = modes.Parse({ "-m", "safe" });
+
+    std::string valid = parser.Parse({ "-i", "1", "-s", "x" }).serialize();
+    xf::cmd::Parser other;
+    other.AddOption({ {"-i", "--int"}, opt_t::make<int>(false, false, true) });
+    bool p4 = (rejected([&]() { parser.Deserialize(valid.substr(0, valid.size() - 1)); })
+               && rejected([&]() { parser.Deserialize("not a result"); })
+               && rejected([&]() { other.Deserialize(valid); })
+               && m1 && rejected([&]() { m1.serialize(); })
+               && parser.Freeze().Deserialize(valid).get<std::string>("-s") == "x");
+
+    return (p1 && p2 && p3 && p4);
+}
+
+bool test_27()
+{
+    xf::cmd::Parser parser;
+    parser.AddOption({ {"-i", "--int"}, opt_t::make<int>(false, false, true) })
+          .AddOption({ {"-s", "--string"}, opt_t::make<std::string>(false, false, true) })
+          .EnableCache(2);
+
+    std::vector<std::string> a{ "-i", "1" }, b{ "-i", "2" }, c{ "-s", "x" }, e{ "-i", "abc" };
+
+    // 相同的参数返回同一个结果; 容量为 2, 淘汰时跳过命中过的 a
+    auto r1 = parser.ParseCached(a);
+    auto r2 = parser.ParseCached(a);
+    auto r3 = parser.ParseCached(b);
+    auto r4 = parser.ParseCached(c);
+    auto r5 = parser.ParseCached(a);
+    auto r6 = parser.ParseCached(b);
+    auto stats = parser.GetCacheStats();
+    bool p1 = (r1 == r2 && r1 == r5 && r3 != r6 && r1->get<int>("-i") == 1 && r6->get<int>("--int") == 2 && r4->get<std::string>("-s") == "x"
+               && 2 == stats.hits && 4 == stats.misses && 2 == stats.evictions && 2 == stats.size && 2 == stats.capacity);
+
+    // { "-i1" } 与 { "-i", "1" } 不同, 出错的结果同样缓存
+    auto r7 = parser.ParseCached({ "-i1" });
+    auto r8 = parser.ParseCached(e);
+    auto r9 = parser.ParseCached(e);
+    bool p2 = (r7 != r1 && xf::cmd::state_t::s_k_unrecognized == r7->code() && r8 == r9 && xf::cmd::state_t::s_v_error == r9->code()
+               && r9->info() == parser.Parse(e).info());
+
+    // 修改参数表后缓存清空, 计数延续; 复制的解析器仍然使用原来的缓存
+    auto frozen = parser.Freeze();
+    auto f1 = frozen.ParseCached(e);
+    parser.AddOption({ {"-n"}, opt_t::make<nullptr_t>(false, false) });
+    auto r10 = parser.ParseCached(e);
+    auto r11 = parser.ParseCached({ "-n" });
+    stats = parser.GetCacheStats();
+    bool p3 = (f1 == r9 && r10 != r9 && r11->is_existing("-n") && 1 == stats.invalidations && 4 == stats.hits && 2 == stats.size
+               && frozen.GetCacheStats().invalidations == 0 && !frozen.ParseCached({ "-n" })->is_valid());
+
+    // 多个线程同时查找和插入
+    parser.EnableCache(16);
+    auto shared = parser.Freeze();
+    std::atomic<int> errors{ 0 };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 2000; ++i)
+            {
+                int n = (i * 7 + t) % 40;
+                auto r = shared.ParseCached({ "-i", std::to_string(n) });
+                if (!*r || r->get<int>("-i") != n || r->info() != "ok")
+                    ++errors;
+            }
+        });
+    }
+
+    for (auto& t : threads)
+        t.join();
+
+    stats = shared.GetCacheStats();
+    bool p4 = (0 == errors && 8000 == stats.hits + stats.misses && 16 == stats.size);
+
+    return (p1 && p2 && p3 && p4);
+}
+
 int main()
 {
-    bool (*test_func_list[])() = { test_0, test_1, test_2, test_3 };
+    bool (*test_func_list[])() = { test_0, test_1, test_2, test_3, test_4, test_5, test_6, test_7, test_8, test_9, test_10, test_11, test_12, test_13, test_14, test_15, test_16, test_17, test_18, test_19, test_20, test_21, test_22, test_23, test_24, test_25, test_26, test_27 };
 
     const unsigned int total = std::extent<decltype(test_func_list)>::value;
     unsigned int ok = 0;
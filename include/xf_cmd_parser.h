@@ -11,12 +11,56 @@ Copyright(c) 2019 Frank Xiong <https://github.com/xf-bnb>.
 #pragma once
 
 #include <functional>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
+#include <bitset>
+#include <array>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <shared_mutex>
+#include <charconv>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <stdexcept>
 #include <regex>
 #include <variant>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <vector>
 #include <set>
 #include <map>
+#include <unordered_map>
+
+// 定义 XF_CMD_NO_SIMD 时只使用标量代码
+#if !defined(XF_CMD_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && 2 <= _M_IX86_FP))
+#define XF_CMD_USE_SSE2
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <sstream>
+#endif
 
 namespace xf::cmd
 {
@@ -37,39 +81,578 @@ namespace xf::cmd
     template<typename _KeyType, typename _ValueType>
     using map_t = std::map<_KeyType, _ValueType>;
 
+    // 使用 std::pmr::memory_resource 分配内存的容器, 解析结果的内部存储使用这些类型
+    namespace pmr
+    {
+        using string_t = std::pmr::string;
+
+        template<typename _Type>
+        using set_t = std::pmr::set<_Type>;
+
+        template<typename _Type>
+        using list_t = std::pmr::vector<_Type>;
+
+        template<typename _KeyType, typename _ValueType>
+        using map_t = std::pmr::map<_KeyType, _ValueType>;
+    }
+
     enum class value_t : unsigned char {
-        vt_nothing, vt_boolean, vt_integer, vt_unsigned, vt_float, vt_string
+        vt_nothing, vt_boolean, vt_integer, vt_unsigned, vt_float, vt_string, vt_custom
     };  // enum value_t
 
-    template<typename _ValueType> struct _type_mapper;
+    // 内置类型之外的类型使用 converter_t 转换
+    template<typename _ValueType> struct _type_mapper { static constexpr value_t _value = value_t::vt_custom; };
     template<> struct _type_mapper<bool> { static constexpr value_t _value = value_t::vt_boolean; };
     template<> struct _type_mapper<int> { static constexpr value_t _value = value_t::vt_integer; };
     template<> struct _type_mapper<unsigned int> { static constexpr value_t _value = value_t::vt_unsigned; };
     template<> struct _type_mapper<double> { static constexpr value_t _value = value_t::vt_float; };
     template<> struct _type_mapper<string_t> { static constexpr value_t _value = value_t::vt_string; };
+    template<> struct _type_mapper<std::string_view> { static constexpr value_t _value = value_t::vt_string; };
     template<> struct _type_mapper<std::nullptr_t> { static constexpr value_t _value = value_t::vt_nothing; };
 
+    // 校验并转换参数值, 单次扫描完成, 与 locale 无关
+    // boolean:  [Tt]rue|[Ff]alse|TRUE|FALSE
+    // unsigned: 0|[1-9][0-9]*
+    // integer:  [+-]?(0|[1-9][0-9]*)
+    // float:    [+-]?(0|[1-9][0-9]*)([.][0-9]+)?
+
+    constexpr bool _from_string(std::string_view v, bool& x)
+    {
+        if (v == "true" || v == "True" || v == "TRUE") { x = true; return true; }
+        if (v == "false" || v == "False" || v == "FALSE") { x = false; return true; }
+        return false;
+    }
+
+    constexpr size_type _scan_digits(std::string_view v, size_type i)
+    {
+        if (i < v.size() && '0' == v[i]) return i + 1;
+        if (i >= v.size() || v[i] < '1' || '9' < v[i]) return i;
+        for (++i; i < v.size() && '0' <= v[i] && v[i] <= '9'; ++i);
+        return i;
+    }
+
+    constexpr bool _from_digits(std::string_view v, unsigned long long limit, unsigned long long& x)
+    {
+        if (v.empty() || _scan_digits(v, 0) != v.size()) return false;
+
+        x = 0;
+        for (auto c : v)
+        {
+            unsigned long long d = static_cast<unsigned long long>(c - '0');
+            if ((limit - d) / 10 < x) return false;
+            x = x * 10 + d;
+        }
+
+        return true;
+    }
+
+    template<typename _Type>
+    constexpr bool _from_unsigned(std::string_view v, _Type& x)
+    {
+        unsigned long long n = 0;
+        if (!_from_digits(v, std::numeric_limits<_Type>::max(), n)) return false;
+        x = static_cast<_Type>(n);
+        return true;
+    }
+
+    template<typename _Type>
+    constexpr bool _from_signed(std::string_view v, _Type& x)
+    {
+        bool negative = (!v.empty() && '-' == v[0]);
+        if (!v.empty() && ('-' == v[0] || '+' == v[0])) v.remove_prefix(1);
+
+        unsigned long long n = 0;
+        unsigned long long limit = static_cast<unsigned long long>(std::numeric_limits<_Type>::max());
+        if (!_from_digits(v, negative ? limit + 1 : limit, n)) return false;
+        x = (negative && 0 < n) ? static_cast<_Type>(-static_cast<_Type>(n - 1) - 1) : static_cast<_Type>(n);
+        return true;
+    }
+
+    constexpr bool _from_string(std::string_view v, unsigned int& x) { return _from_unsigned(v, x); }
+    constexpr bool _from_string(std::string_view v, int& x) { return _from_signed(v, x); }
+
+    template<typename _Type>
+    inline bool _from_float(std::string_view v, _Type& x)
+    {
+        size_type i = (!v.empty() && ('-' == v[0] || '+' == v[0])) ? 1 : 0;
+        size_type k = _scan_digits(v, i);
+        if (k == i) return false;
+
+        if (k < v.size())
+        {
+            if ('.' != v[k]) return false;
+            size_type n = ++k;
+            for (; k < v.size() && '0' <= v[k] && v[k] <= '9'; ++k);
+            if (k == n || k != v.size()) return false;
+        }
+
+        if ('+' == v.front()) v.remove_prefix(1);
+        auto r = std::from_chars(v.data(), v.data() + v.size(), x);
+        return (std::errc() == r.ec && r.ptr == v.data() + v.size());
+    }
+
+    inline bool _from_string(std::string_view v, double& x) { return _from_float(v, x); }
+
+    inline bool _from_string(std::string_view v, string_t& x)
+    {
+        if (v.empty()) return false;
+        x.assign(v.data(), v.size());
+        return true;
+    }
+
+    constexpr bool _from_string(std::string_view v, std::string_view& x)
+    {
+        if (v.empty()) return false;
+        x = v;
+        return true;
+    }
+
+    // 参数值的转换器, 为自定义类型特化 converter_t 即可在解析时完成校验和转换:
+    //   static bool from_string(std::string_view v, T& x);   // 校验并转换
+    //   static string_t to_string(const T& x);               // 可选, 用于 result_t::args()
+    // 已经提供了所有整数类型(如 std::int64_t、std::uint64_t)和浮点类型的转换器
+    template<typename _Type, typename = void>
+    struct converter_t;
+
+    template<typename _Type>
+    struct converter_t<_Type, std::enable_if_t<std::is_integral_v<_Type> && !std::is_same_v<_Type, bool>>>
+    {
+        static bool from_string(std::string_view v, _Type& x)
+        {
+            if constexpr (std::is_signed_v<_Type>)
+                return _from_signed(v, x);
+            else
+                return _from_unsigned(v, x);
+        }
+
+        static string_t to_string(const _Type& x) { return std::to_string(x); }
+    };
+
+    template<typename _Type>
+    struct converter_t<_Type, std::enable_if_t<std::is_floating_point_v<_Type>>>
+    {
+        static bool from_string(std::string_view v, _Type& x) { return _from_float(v, x); }
+        static string_t to_string(const _Type& x) { return std::to_string(x); }
+    };
+
+    template<typename _Type, typename = void>
+    struct _has_to_string : std::false_type { };
+
+    template<typename _Type>
+    struct _has_to_string<_Type, std::void_t<decltype(converter_t<_Type>::to_string(std::declval<const _Type&>()))>> : std::true_type { };
+
+    // 自定义的转换函数抛出异常时视为转换失败, 解析过程不会抛出异常
+    template<typename _Type>
+    bool _convert(std::string_view v, _Type& x)
+    {
+        if constexpr (value_t::vt_custom == _type_mapper<_Type>::_value)
+        {
+            try {
+                return converter_t<_Type>::from_string(v, x);
+            } catch (...) {
+                return false;
+            }
+        }
+        else
+        {
+            return _from_string(v, x);
+        }
+    }
+
+    // 自定义类型的值: 可平凡复制且不超过 16 字节的类型保存在内部缓冲区中, 其他类型在堆上分配
+    class _custom_t
+    {
+        struct _ops_t
+        {
+            void (*copy)(void* dst, const void* src);
+            void (*destroy)(void* p);
+            string_t (*to_string)(const void* p);
+            bool printable;         // 提供了 converter_t::to_string
+        };
+
+        static constexpr size_type _size = 16;
+
+        template<typename _Type>
+        static constexpr bool _is_inline = (std::is_trivially_copyable_v<_Type> && sizeof(_Type) <= _size && alignof(_Type) <= alignof(std::max_align_t));
+
+        template<typename _Type>
+        static const _Type* _pointer(const void* p)
+        {
+            if constexpr (_is_inline<_Type>)
+                return std::launder(static_cast<const _Type*>(p));
+            else
+                return *static_cast<_Type* const*>(p);
+        }
+
+        // 每个类型一个操作表, 同时作为类型标识
+        template<typename _Type>
+        static constexpr _ops_t _ops_of{
+            [](void* dst, const void* src) {
+                if constexpr (_is_inline<_Type>)
+                    std::memcpy(dst, src, sizeof(_Type));
+                else
+                    *static_cast<_Type**>(dst) = new _Type(*_pointer<_Type>(src));
+            },
+            [](void* p) {
+                if constexpr (!_is_inline<_Type>)
+                    delete *static_cast<_Type**>(p);
+            },
+            [](const void* p) {
+                if constexpr (_has_to_string<_Type>::value)
+                    return string_t(converter_t<_Type>::to_string(*_pointer<_Type>(p)));
+                else
+                    return string_t();
+            },
+            _has_to_string<_Type>::value
+        };
+
+        alignas(std::max_align_t) unsigned char _buffer[_size];
+        const _ops_t* _ops{ nullptr };
+
+    public:
+
+        _custom_t() = default;
+        _custom_t(const _custom_t& other) : _ops(other._ops) { if (_ops) _ops->copy(_buffer, other._buffer); }
+        _custom_t(_custom_t&& other) noexcept : _ops(other._ops) { std::memcpy(_buffer, other._buffer, _size); other._ops = nullptr; }
+        ~_custom_t() { if (_ops) _ops->destroy(_buffer); }
+
+        _custom_t& operator=(_custom_t other) noexcept
+        {
+            std::swap(_ops, other._ops);
+            unsigned char t[_size];
+            std::memcpy(t, _buffer, _size);
+            std::memcpy(_buffer, other._buffer, _size);
+            std::memcpy(other._buffer, t, _size);
+            return *this;
+        }
+
+        template<typename _Type>
+        static bool convert(std::string_view v, _custom_t& x)
+        {
+            if constexpr (_is_inline<_Type>)
+            {
+                _Type* p = new (x._buffer) _Type();
+                if (!_convert(v, *p)) return false;
+            }
+            else
+            {
+                auto p = std::make_unique<_Type>();
+                if (!_convert(v, *p)) return false;
+                *reinterpret_cast<_Type**>(x._buffer) = p.release();
+            }
+
+            x._ops = &_ops_of<_Type>;
+            return true;
+        }
+
+        // 类型不同时返回空指针
+        template<typename _Type>
+        const _Type* get() const { return (&_ops_of<_Type> == _ops ? _pointer<_Type>(_buffer) : nullptr); }
+
+        string_t to_string() const { return (_ops ? _ops->to_string(_buffer) : string_t()); }
+
+        bool is_printable() const { return (_ops && _ops->printable); }
+
+    };  // class _custom_t
+
+    // 参数值的模式: 定义选项时编译一次, 之后只做匹配
+    // 由字面字符、字符类([...]、\d)、量词(? * +)和顶层的'|'组成的模式编译为 DFA, 其余模式编译为 std::regex
+    class _pattern_t
+    {
+        using _charset = std::bitset<256>;
+
+        struct _atom_t { _charset chars; char quantifier; };
+
+        static constexpr size_type _max_states = 256;
+
+        list_t<std::array<unsigned short, 256>> _table;     // 状态转移表, 0 为死状态, 1 为初始状态
+        list_t<bool> _accept;
+        std::unique_ptr<const std::regex> _regex;
+
+    public:
+
+        explicit _pattern_t(const string_t& expr)
+        {
+            list_t<list_t<_atom_t>> branches;
+            if (!(_parse(expr, branches) && _compile(branches)))
+            {
+                _table.clear();
+                _accept.clear();
+                _regex = std::make_unique<const std::regex>(expr);
+            }
+        }
+
+        bool match(std::string_view v) const
+        {
+            if (_regex)
+                return std::regex_match(v.begin(), v.end(), *_regex);
+
+            unsigned short s = 1;
+            for (unsigned char c : v)
+            {
+                s = _table[s][c];
+                if (0 == s) return false;
+            }
+
+            return _accept[s];
+        }
+
+        // 按字典序列出以 prefix 开头并且匹配模式的字符串, 最多 limit 个, 用于补全
+        // 在 limit 之内发现匹配的字符串有无限个或者使用正则表达式时返回 false
+        bool enumerate(std::string_view prefix, list_t<string_t>& values, size_type limit) const
+        {
+            if (_regex)
+                return false;
+
+            unsigned short s = 1;
+            for (unsigned char c : prefix)
+            {
+                s = _table[s][c];
+                if (0 == s) return true;
+            }
+
+            list_t<bool> visiting(_table.size(), false);
+            string_t value(prefix);
+            return _enumerate(s, value, visiting, values, limit);
+        }
+
+    private:
+
+        bool _enumerate(unsigned short s, string_t& value, list_t<bool>& visiting, list_t<string_t>& values, size_type limit) const
+        {
+            if (visiting[s])
+                return false;
+
+            if (_accept[s] && values.size() < limit)
+                values.push_back(value);
+
+            visiting[s] = true;
+            for (unsigned int c = 0; c < 256 && values.size() < limit; ++c)
+            {
+                if (0 == _table[s][c])
+                    continue;
+
+                value.push_back(static_cast<char>(c));
+                bool finite = _enumerate(_table[s][c], value, visiting, values, limit);
+                value.pop_back();
+                if (!finite)
+                    return false;
+            }
+            visiting[s] = false;
+
+            return true;
+        }
+
+        static bool _is_nullable(const _atom_t& atom) { return ('?' == atom.quantifier || '*' == atom.quantifier); }
+
+        static bool _parse_class(const string_t& expr, size_type& i, _charset& chars)
+        {
+            size_type j = i + 1;
+            bool negative = (j < expr.size() && '^' == expr[j]);
+            if (negative) ++j;
+
+            if (j < expr.size() && ']' == expr[j])
+                return false;
+
+            for (; j < expr.size() && ']' != expr[j]; ++j)
+            {
+                unsigned char a = expr[j];
+                if ('\\' == a || '[' == a)
+                    return false;
+
+                if (j + 2 < expr.size() && '-' == expr[j + 1] && ']' != expr[j + 2])
+                {
+                    unsigned char b = expr[j + 2];
+                    if ('\\' == b || '[' == b || b < a)
+                        return false;
+
+                    for (unsigned int c = a; c <= b; ++c) chars.set(c);
+                    j += 2;
+                }
+                else
+                {
+                    chars.set(a);
+                }
+            }
+
+            if (j == expr.size())
+                return false;
+
+            if (negative) chars.flip();
+            i = j;
+            return true;
+        }
+
+        static bool _parse(const string_t& expr, list_t<list_t<_atom_t>>& branches)
+        {
+            branches.emplace_back();
+            for (size_type i = 0; i < expr.size(); ++i)
+            {
+                auto& atoms = branches.back();
+                unsigned char c = expr[i];
+                _atom_t atom{ _charset(), 0 };
+
+                switch (c)
+                {
+                case '|':
+                    branches.emplace_back();
+                    continue;
+                case '?': case '*': case '+':
+                    if (atoms.empty() || 0 != atoms.back().quantifier)
+                        return false;
+                    atoms.back().quantifier = c;
+                    continue;
+                case '[':
+                    if (!_parse_class(expr, i, atom.chars))
+                        return false;
+                    break;
+                case '\\':
+                    if (++i == expr.size())
+                        return false;
+                    if ('d' == expr[i])
+                    {
+                        for (unsigned int d = '0'; d <= '9'; ++d) atom.chars.set(d);
+                    }
+                    else if (std::string_view::npos != std::string_view(R"(\^$.|?*+()[]{}/)").find(expr[i]))
+                        atom.chars.set(static_cast<unsigned char>(expr[i]));
+                    else
+                        return false;
+                    break;
+                case '(': case ')': case '{': case '}': case '.': case '^': case '$': case ']':
+                    return false;
+                default:
+                    atom.chars.set(c);
+                    break;
+                }
+
+                atoms.push_back(atom);
+            }
+
+            return true;
+        }
+
+        bool _compile(const list_t<list_t<_atom_t>>& branches)
+        {
+            // Glushkov 自动机: 状态为刚刚匹配过的原子位置的集合
+            list_t<_atom_t> atoms;
+            list_t<list_t<size_type>> follow;
+            list_t<bool> last;
+            list_t<size_type> first;
+            bool empty = false;
+
+            for (auto& branch : branches)
+            {
+                size_type base = atoms.size();
+                atoms.insert(atoms.end(), branch.begin(), branch.end());
+
+                auto reach = [&branch, base](size_type j, list_t<size_type>& positions) {
+                    for (; j < branch.size(); ++j)
+                    {
+                        positions.push_back(base + j);
+                        if (!_is_nullable(branch[j])) return false;
+                    }
+                    return true;
+                };
+
+                if (reach(0, first)) empty = true;
+
+                for (size_type j = 0; j < branch.size(); ++j)
+                {
+                    list_t<size_type> positions;
+                    if ('*' == branch[j].quantifier || '+' == branch[j].quantifier)
+                        positions.push_back(base + j);
+
+                    last.push_back(reach(j + 1, positions));
+                    follow.push_back(positions);
+                }
+            }
+
+            map_t<list_t<size_type>, unsigned short> ids;
+            list_t<list_t<size_type>> states(2);
+            _table.assign(2, std::array<unsigned short, 256>{});
+            _accept = { false, empty };
+
+            for (size_type s = 1; s < states.size(); ++s)
+            {
+                set_t<size_type> candidates;
+                if (1 == s)
+                    candidates.insert(first.begin(), first.end());
+                else
+                    for (auto p : states[s]) candidates.insert(follow[p].begin(), follow[p].end());
+
+                for (unsigned int c = 0; c < 256; ++c)
+                {
+                    list_t<size_type> next;
+                    for (auto q : candidates)
+                        if (atoms[q].chars.test(c)) next.push_back(q);
+
+                    if (next.empty())
+                        continue;
+
+                    auto iter = ids.find(next);
+                    if (iter == ids.end())
+                    {
+                        if (_max_states <= states.size())
+                            return false;
+
+                        bool accept = false;
+                        for (auto q : next) accept = accept || last[q];
+
+                        iter = ids.emplace(next, static_cast<unsigned short>(states.size())).first;
+                        states.push_back(next);
+                        _table.emplace_back();
+                        _accept.push_back(accept);
+                    }
+
+                    _table[s][c] = iter->second;
+                }
+            }
+
+            return true;
+        }
+
+    };  // class _pattern_t
+
+    // 类型标识, 用于确认绑定的结构体类型, 不依赖 RTTI
+    template<typename _Type>
+    struct _type_tag { static constexpr char id{ 0 }; };
+
     class option_t
     {
+        friend class Parser;
+        friend class result_t;
+
     public:
 
         static inline bool is_string(const string_t& v) { return !v.empty(); }
-        static inline bool is_boolean(const string_t& v) { return std::regex_match(v, std::regex("[Tt]rue|[Ff]alse|TRUE|FALSE")); }
-        static inline bool is_integer(const string_t& v) { return std::regex_match(v, std::regex("[+-]?(0|[1-9][0-9]*)")); }
-        static inline bool is_unsigned(const string_t& v) { return std::regex_match(v, std::regex("0|[1-9][0-9]*")); }
-        static inline bool is_float(const string_t& v) { return std::regex_match(v, std::regex("[+-]?(0|[1-9][1-9]*)([.][0-9]+)?")); }
+        static inline bool is_boolean(const string_t& v) { bool x{}; return _from_string(v, x); }
+        static inline bool is_integer(const string_t& v) { int x{}; return _from_string(v, x); }
+        static inline bool is_unsigned(const string_t& v) { unsigned int x{}; return _from_string(v, x); }
+        static inline bool is_float(const string_t& v) { double x{}; return _from_string(v, x); }
 
     private:
 
         using _CallType = std::function<bool (const string_t&)>;
 
+        // 将参数值直接写入结构体的成员, value 为空指针表示参数没有值
+        using _BindType = std::function<bool (void* object, const std::string_view* value)>;
+
+        // vt_custom 类型的值使用 converter_t 校验并转换
+        using _ConvertType = bool (*)(std::string_view value, _custom_t& x);
+
         value_t _vt;
         bool _is_unique;
         bool _k_required;
         bool _v_required;
         _CallType _check;
+        std::shared_ptr<const _pattern_t> _pattern;
+        _BindType _bind;
+        const void* _bind_type{ nullptr };
+        bool _is_multiple{ false };
+        char _delimiter{ 0 };
+        _ConvertType _convert{ nullptr };
 
-        static constexpr bool (*_func_list[])(const string_t&){ nullptr, is_boolean, is_integer, is_unsigned, is_float, is_string };
+        static constexpr bool (*_func_list[])(const string_t&){ nullptr, is_boolean, is_integer, is_unsigned, is_float, is_string, nullptr };
 
     public:
 
@@ -80,11 +663,13 @@ namespace xf::cmd
         { }
 
         option_t(const value_t& vt, bool u, bool k, bool v, const string_t& expr)
-            : option_t(vt, u, k, v, [expr](const string_t& value) { return std::regex_match(value, std::regex(expr)); })
-        { }
+            : option_t(vt, u, k, v, _CallType())
+        {
+            _pattern = std::make_shared<const _pattern_t>(expr);
+        }
 
         option_t(const value_t& vt, bool u, bool k, bool v)
-            : option_t(vt, u, k, v, _func_list[static_cast<size_type>(vt)])
+            : option_t(vt, u, k, v, _CallType())
         { }
 
         option_t(bool u, bool k)
@@ -95,20 +680,66 @@ namespace xf::cmd
         bool is_unique() const { return _is_unique; }
         bool is_key_required() const { return _k_required; }
         bool is_value_required() const { return _v_required; }
-        bool check(const string_t& value) const { return (_check && (_check(value))); }
+        bool is_multiple() const { return _is_multiple; }
+        char delimiter() const { return _delimiter; }
+
+        // 允许参数重复出现, delimiter 不为 0 时一个值可以包含多个以 delimiter 分隔的值, 所有值按顺序连续保存
+        // 自定义类型(vt_custom, 包括 std::int64_t 等 64 位整数)的值不能按 get_list 连续保存, 定义参数时抛出 std::invalid_argument
+        option_t& multiple(char delimiter = 0)
+        {
+            if (value_t::vt_custom == _vt)
+                throw std::invalid_argument("repeated values of custom types are not supported.");
+
+            _is_multiple = true;
+            _delimiter = delimiter;
+            return *this;
+        }
+
+        bool check(const string_t& value) const
+        {
+            if (_check) return _check(value);
+            if (_pattern) return _pattern->match(value);
+            if (_convert) { _custom_t x; return _convert(value, x); }
+
+            auto func = _func_list[static_cast<size_type>(_vt)];
+            return (func && func(value));
+        }
 
         template<typename _ValueType, typename _CheckType>
         static option_t make(bool u, bool k, bool v, _CheckType checker) {
-            return option_t(_type_mapper<_ValueType>::_value, u, k, v, checker);
+            return option_t(_type_mapper<_ValueType>::_value, u, k, v, checker)._converter<_ValueType>();
         }
 
         template<typename _ValueType>
         static option_t make(bool u, bool k, bool v) {
-            return option_t(_type_mapper<_ValueType>::_value, u, k, v);
+            return option_t(_type_mapper<_ValueType>::_value, u, k, v)._converter<_ValueType>();
         }
 
         template<typename _ValueType> static option_t make(bool, bool);
 
+    private:
+
+        template<typename _ValueType>
+        option_t& _converter()
+        {
+            if constexpr (value_t::vt_custom == _type_mapper<_ValueType>::_value)
+                _convert = &_custom_t::convert<_ValueType>;
+            return *this;
+        }
+
+        // 内置类型的校验与转换合并在 result_t::_add_value 中完成
+        bool _is_builtin() const { return (!_check && !_pattern); }
+
+        // 自定义的校验函数抛出异常时视为校验失败, 解析过程不会抛出异常
+        bool _check_value(std::string_view value) const
+        {
+            try {
+                return (_pattern ? _pattern->match(value) : check(string_t(value)));
+            } catch (...) {
+                return false;
+            }
+        }
+
     };  // class option_t
 
     template<> option_t option_t::make<std::nullptr_t>(bool u, bool k) { return option_t(u, k); }
@@ -122,375 +753,3644 @@ namespace xf::cmd
         s_k_missing,            // 缺少必需的参数
         s_v_missing,            // 参数值缺失
         s_v_redundant,          // 参数值多余
-        s_v_error               // 参数值错误
+        s_v_error,              // 参数值错误
+        s_f_error               // 响应文件错误
     };  // enum state_t
 
     template<typename _Type> string_t _to_string(const _Type& v) { return std::to_string(v); }
     template<> string_t _to_string(const std::nullptr_t& v) { return ""; }
     template<> string_t _to_string(const bool& v) { return (v ? "true" : "false"); }
     template<> string_t _to_string(const string_t& v) { return v; }
+    template<> string_t _to_string(const std::string_view& v) { return string_t(v); }
+    template<> string_t _to_string(const pmr::string_t& v) { return string_t(v); }
+    template<> string_t _to_string(const _custom_t& v) { return v.to_string(); }
 
-    class result_t
+    inline string_t _join(std::initializer_list<std::string_view> parts)
     {
-        friend class Parser;
+        size_type n = 0;
+        for (auto p : parts) n += p.size();
 
-        using variant_t = std::variant<std::nullptr_t, bool, int, unsigned int, double, string_t>;
+        string_t x;
+        x.reserve(n);
+        for (auto p : parts) x.append(p.data(), p.size());
+
+        return x;
+    }
 
-        static string_t _to_string(const variant_t& v)
+    inline string_t _make_info(state_t s, std::string_view a, std::string_view b)
+    {
+        switch (s)
         {
-            string_t x;
-            std::visit([&](auto&& t) mutable { x = xf::cmd::_to_string(t); }, v);
-            return x;
+        case state_t::s_ok:
+            return "ok";
+        case state_t::s_nothing:
+            return R"(error: don't get any parameter.)";
+        case state_t::s_k_unrecognized:
+            return _join({ R"(error: unrecognized parameter ")", a, R"(".)" });
+        case state_t::s_k_duplicated:
+            return _join({ R"(error: repeat paramter ")", a, R"(" and ")", b, R"(".)" });
+        case state_t::s_k_missing:
+            if (!b.empty())
+                return _join({ R"(error: the parameter ")", a, R"(" must be specified with ")", b, R"(".)" });
+            return _join({ R"(error: the parameter ")", a, R"(" must be specified but not found.)" });
+        case state_t::s_v_missing:
+            return _join({ R"(error: parameter ")", a, R"(" must specify a value.)" });
+        case state_t::s_v_redundant:
+            return _join({ R"(error: the parameter ")", a, R"(" doesn't require value.)" });
+        case state_t::s_v_error:
+            return _join({ R"(error: the ")", b, R"(" can't be treated as the value of parameter ")", a, R"(".)" });
+        case state_t::s_k_conflict:
+            if (!b.empty())
+                return _join({ R"(error: parameter ")", a, R"(" can't be specified with ")", b, R"(".)" });
+            return _join({ R"(error: parameter ")", a, R"(" can't be specified with other parameters.)" });
+        case state_t::s_f_error:
+            return _join({ R"(error: can't read the response file ")", a, R"(")", (b.empty() ? "" : ": "), b, "." });
+        default:
+            return string_t();
         }
+    }
 
-        state_t _state;
-        string_t _info;
-        pair_t<string_t, string_t> _extra;
-        map_t<string_t, string_t> _k_map;
-        map_t<string_t, variant_t> _v_map;
-        bool _is_unique{ false };
 
-        result_t(state_t code, const string_t& text) : _state(code), _info(text) { }
+    inline unsigned int _lowest_bit(std::uint64_t x)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned int>(__builtin_ctzll(x));
+#else
+        unsigned int i = 0;
+        for (; 0 == (x & 1); x >>= 1) ++i;
+        return i;
+#endif
+    }
+
+#if defined(XF_CMD_USE_SSE2)
+
+    inline unsigned int _first_bit(unsigned int mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long i = 0;
+        _BitScanForward(&i, mask);
+        return static_cast<unsigned int>(i);
+#else
+        return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+    }
+
+    // 每次比较 16 个字符, 不足 16 个的部分由调用者逐个处理
+    template<typename _MatchType>
+    size_type _scan16(std::string_view text, size_type pos, _MatchType match)
+    {
+        for (; pos + 16 <= text.size(); pos += 16)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + pos));
+            if (int mask = _mm_movemask_epi8(match(x)))
+                return pos + _first_bit(static_cast<unsigned int>(mask));
+        }
 
-    public:
+        return pos;
+    }
 
-        state_t code() const { return _state; }
-        const string_t& info() const { return _info; }
-        const pair_t<string_t, string_t>& hint() const { return _extra; }
-        bool is_valid() const { return (state_t::s_ok == code()); }
-        bool is_existing(const string_t& key) const { return _k_map.find(key) != _k_map.end(); }
+#endif
 
-        operator bool() const { return is_valid(); }
-        operator const string_t& () const { return info(); }
+    // 按 POSIX shell 的规则切分命令行: 空白分隔, 支持单引号、双引号和反斜杠转义
+    // 不含引号和转义的参数直接返回输入中的片段, 否则还原到内部缓冲区后返回, 下一次调用 next 前有效
+    // 支持 SSE2 时一次扫描 16 个字符查找空白、引号和反斜杠
+    class _tokenizer_t
+    {
+        std::string_view _text;
+        size_type _pos{ 0 };
+        string_t _buffer;
+        bool _is_copied{ false };
+
+        static bool _is_space(char c) { return (' ' == c || '\t' == c || '\n' == c || '\r' == c || '\v' == c || '\f' == c); }
+        static bool _is_special(char c) { return ('\\' == c || '\'' == c || '"' == c); }
+
+        // 第一个空白、引号或者反斜杠的位置
+        static size_type _find_delimiter(std::string_view text, size_type pos)
+        {
+#if defined(XF_CMD_USE_SSE2)
+            pos = _scan16(text, pos, [](__m128i x) {
+                __m128i d = _mm_sub_epi8(x, _mm_set1_epi8('\t'));     // '\t' ~ '\r' 变为 0 ~ 4
+                __m128i m = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(4)), d);
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(x, _mm_set1_epi8(' ')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(x, _mm_set1_epi8('\\')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(x, _mm_set1_epi8('\'')));
+                return _mm_or_si128(m, _mm_cmpeq_epi8(x, _mm_set1_epi8('"')));
+            });
+#endif
+            for (; pos < text.size() && !_is_space(text[pos]) && !_is_special(text[pos]); ++pos);
+            return pos;
+        }
+
+        // 双引号中第一个双引号或者反斜杠的位置
+        static size_type _find_quoted(std::string_view text, size_type pos)
+        {
+#if defined(XF_CMD_USE_SSE2)
+            pos = _scan16(text, pos, [](__m128i x) {
+                return _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('"')), _mm_cmpeq_epi8(x, _mm_set1_epi8('\\')));
+            });
+#endif
+            for (; pos < text.size() && '"' != text[pos] && '\\' != text[pos]; ++pos);
+            return pos;
+        }
+
+        bool _at(char c) const { return (_pos < _text.size() && c == _text[_pos]); }
+
+    public:
 
-        bool has_value(const string_t& key) const
+        explicit _tokenizer_t(std::string_view text) : _text(text) { }
+
+        bool next(std::string_view& token)
         {
-            auto k_iter = _k_map.find(key);
-            if (k_iter == _k_map.end())
+            for (; _pos < _text.size(); ++_pos)
+            {
+                if ('\\' == _text[_pos] && _pos + 1 < _text.size() && '\n' == _text[_pos + 1])
+                    ++_pos;
+                else if (!_is_space(_text[_pos]))
+                    break;
+            }
+
+            if (_pos == _text.size())
                 return false;
 
-            auto v_iter = _v_map.find(k_iter->second);
-            if (v_iter == _v_map.end())
+            size_type begin = _pos;
+            _pos = _find_delimiter(_text, _pos);
+
+            _is_copied = !(_pos == _text.size() || _is_space(_text[_pos]));
+            if (!_is_copied)
+            {
+                token = _text.substr(begin, _pos - begin);
+                return true;
+            }
+
+            _buffer.assign(_text.data() + begin, _pos - begin);
+            while (_pos < _text.size() && !_is_space(_text[_pos]))
+            {
+                char c = _text[_pos++];
+                switch (c)
+                {
+                case '\\':
+                    if (_pos < _text.size())
+                    {
+                        if ('\n' != _text[_pos]) _buffer += _text[_pos];
+                        ++_pos;
+                    }
+                    break;
+                case '\'':
+                {
+                    size_type end = std::min(_text.find('\'', _pos), _text.size());
+                    _buffer.append(_text.data() + _pos, end - _pos);
+                    _pos = end;
+                    if (_at('\'')) ++_pos;
+                    break;
+                }
+                case '"':
+                    for (;;)
+                    {
+                        size_type end = _find_quoted(_text, _pos);
+                        _buffer.append(_text.data() + _pos, end - _pos);
+                        _pos = end;
+                        if (_pos == _text.size() || '"' == _text[_pos])
+                            break;
+
+                        if (_pos + 1 < _text.size() && std::string_view::npos != std::string_view("$`\"\\\n").find(_text[_pos + 1]))
+                        {
+                            if ('\n' != _text[++_pos]) _buffer += _text[_pos];
+                        }
+                        else
+                        {
+                            _buffer += '\\';
+                        }
+                        ++_pos;
+                    }
+                    if (_at('"')) ++_pos;
+                    break;
+                default:
+                {
+                    size_type end = _find_delimiter(_text, _pos);
+                    _buffer += c;
+                    _buffer.append(_text.data() + _pos, end - _pos);
+                    _pos = end;
+                    break;
+                }
+                }
+            }
+
+            token = _buffer;
+            return true;
+        }
+
+        // 上一次返回的参数是否还原到了内部缓冲区中
+        bool is_copied() const { return _is_copied; }
+
+    };  // class _tokenizer_t
+
+    // 以只读方式映射到内存的文件, 不支持 mmap 的平台将文件读入内存
+    class _mapped_file_t
+    {
+        std::string_view _data;
+        string_t _id;       // 用于识别同一个文件
+        bool _is_open{ false };
+
+#if defined(__unix__) || defined(__APPLE__)
+
+        void* _addr{ MAP_FAILED };
+
+    public:
+
+        explicit _mapped_file_t(const string_t& path)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return;
+
+            struct stat st;
+            if (0 == ::fstat(fd, &st) && S_ISREG(st.st_mode))
+            {
+                _id = std::to_string(st.st_dev) + ":" + std::to_string(st.st_ino);
+                if (0 < st.st_size)
+                {
+                    _addr = ::mmap(nullptr, static_cast<size_type>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (MAP_FAILED != _addr)
+                        _data = std::string_view(static_cast<const char*>(_addr), static_cast<size_type>(st.st_size));
+                }
+
+                _is_open = (0 == st.st_size || MAP_FAILED != _addr);
+            }
+
+            ::close(fd);
+        }
+
+        ~_mapped_file_t()
+        {
+            if (MAP_FAILED != _addr)
+                ::munmap(_addr, _data.size());
+        }
+
+#else
+
+        string_t _buffer;
+
+    public:
+
+        explicit _mapped_file_t(const string_t& path) : _id(path)
+        {
+            std::ifstream file(path, std::ios::in | std::ios::binary);
+            if (file)
+            {
+                std::ostringstream stream;
+                stream << file.rdbuf();
+                _buffer = stream.str();
+                _data = _buffer;
+                _is_open = true;
+            }
+        }
+
+#endif
+
+        _mapped_file_t(const _mapped_file_t&) = delete;
+        _mapped_file_t& operator=(const _mapped_file_t&) = delete;
+
+        bool is_open() const { return _is_open; }
+        std::string_view data() const { return _data; }
+        const string_t& id() const { return _id; }
+
+    };  // class _mapped_file_t
+
+    // 参数名索引: 字典树, 随 AddOption/RemoveOption 增量维护
+    // 一次查找即可得到作为前缀的最长参数名, 再判断其后是结尾还是'='
+    class _key_index_t
+    {
+    public:
+
+        using id_type = unsigned int;
+
+    private:
+
+        using _next_type = list_t<pair_t<unsigned char, unsigned int>>;
+
+        struct _node_t
+        {
+            id_type id{ 0 };
+            string_t key;
+            _next_type next;    // 按字符排序, 0 表示不存在的子节点
+        };
+
+        list_t<_node_t> _nodes{ 1 };
+        id_type _bound{ 1 };
+
+        static _next_type::const_iterator _lower_bound(const _next_type& next, unsigned char c)
+        {
+            return std::lower_bound(next.begin(), next.end(), c, [](const _next_type::value_type& a, unsigned char b) { return a.first < b; });
+        }
+
+        unsigned int _child(unsigned int n, unsigned char c) const
+        {
+            auto& next = _nodes[n].next;
+            auto iter = _lower_bound(next, c);
+            return (iter != next.end() && c == iter->first) ? iter->second : 0;
+        }
+
+    public:
+
+        // id 的上界, 结果中按 id 索引的数组以此为长度
+        id_type bound() const { return _bound; }
+
+        void insert(std::string_view key, id_type id)
+        {
+            unsigned int n = 0;
+            for (unsigned char c : key)
+            {
+                auto& next = _nodes[n].next;
+                auto iter = _lower_bound(next, c);
+                if (iter != next.end() && c == iter->first)
+                {
+                    n = iter->second;
+                }
+                else
+                {
+                    unsigned int m = static_cast<unsigned int>(_nodes.size());
+                    next.emplace(iter, c, m);
+                    _nodes.emplace_back();
+                    n = m;
+                }
+            }
+
+            _nodes[n].id = id;
+            _nodes[n].key.assign(key.data(), key.size());
+            if (_bound <= id) _bound = id + 1;
+        }
+
+        void erase(std::string_view key)
+        {
+            unsigned int n = 0;
+            for (unsigned char c : key)
+            {
+                n = _child(n, c);
+                if (0 == n) return;
+            }
+
+            _nodes[n].id = 0;
+            _nodes[n].key.clear();
+        }
+
+        id_type find(std::string_view key) const
+        {
+            unsigned int n = 0;
+            for (unsigned char c : key)
+            {
+                n = _child(n, c);
+                if (0 == n) return 0;
+            }
+
+            return _nodes[n].id;
+        }
+
+        // 索引中保存的参数名, 与索引的生命周期相同; 不存在时为空
+        std::string_view find_key(std::string_view key) const
+        {
+            unsigned int n = 0;
+            for (unsigned char c : key)
+            {
+                n = _child(n, c);
+                if (0 == n) return std::string_view();
+            }
+
+            return _nodes[n].key;
+        }
+
+        // 返回最长的前缀参数名对应的 id 及索引中保存的参数名, id 为 0 表示没有匹配
+        pair_t<id_type, std::string_view> match(std::string_view text) const
+        {
+            pair_t<id_type, std::string_view> result(_nodes[0].id, _nodes[0].key);
+
+            unsigned int n = 0;
+            for (unsigned char c : text)
+            {
+                n = _child(n, c);
+                if (0 == n) break;
+
+                if (0 < _nodes[n].id)
+                    result = { _nodes[n].id, _nodes[n].key };
+            }
+
+            return result;
+        }
+
+        // 按字典序访问以 prefix 开头的参数名, func 返回 false 时停止
+        template<typename _FuncType>
+        void visit(std::string_view prefix, _FuncType func) const
+        {
+            unsigned int n = 0;
+            for (unsigned char c : prefix)
+            {
+                n = _child(n, c);
+                if (0 == n) return;
+            }
+
+            _visit(n, func);
+        }
+
+    private:
+
+        template<typename _FuncType>
+        bool _visit(unsigned int n, _FuncType& func) const
+        {
+            if (0 < _nodes[n].id && !func(_nodes[n].id, std::string_view(_nodes[n].key)))
                 return false;
 
-            return (static_cast<size_type>(value_t::vt_nothing) != v_iter->second.index());
+            for (auto& next : _nodes[n].next)
+            {
+                if (!_visit(next.second, func))
+                    return false;
+            }
+
+            return true;
         }
 
-        template<typename _Type>
-        _Type get(const string_t& key) const
+    };  // class _key_index_t
+
+    // 参数句柄: 保存参数的 id, 用于在解析结果中直接取值
+    template<typename _ValueType>
+    class handle_t
+    {
+        friend class Parser;
+        friend class result_t;
+
+        _key_index_t::id_type _id{ 0 };
+
+        explicit handle_t(_key_index_t::id_type id) : _id(id) { }
+
+    public:
+
+        using value_type = _ValueType;
+
+        handle_t() = default;
+
+        bool is_valid() const { return (0 < _id); }
+        explicit operator bool() const { return is_valid(); }
+
+        unsigned int id() const { return _id; }
+
+    };  // class handle_t
+
+    // 连续存储的一组值的只读视图, 在解析结果的生命周期内有效
+    template<typename _Type>
+    class span_t
+    {
+        _Type* _data{ nullptr };
+        size_type _size{ 0 };
+
+    public:
+
+        using value_type = std::remove_cv_t<_Type>;
+        using iterator = _Type*;
+
+        span_t() = default;
+        span_t(_Type* data, size_type n) : _data(data), _size(n) { }
+
+        _Type* data() const { return _data; }
+        size_type size() const { return _size; }
+        bool empty() const { return (0 == _size); }
+        iterator begin() const { return _data; }
+        iterator end() const { return _data + _size; }
+        _Type& operator[](size_type i) const { return _data[i]; }
+        _Type& front() const { return _data[0]; }
+        _Type& back() const { return _data[_size - 1]; }
+
+    };  // class span_t
+
+    // bool 的列表按位保存, 没有 data()
+    template<>
+    class span_t<const bool>
+    {
+        const pmr::list_t<bool>* _list{ nullptr };
+
+    public:
+
+        using value_type = bool;
+        using iterator = pmr::list_t<bool>::const_iterator;
+
+        span_t() = default;
+        explicit span_t(const pmr::list_t<bool>* list) : _list(list) { }
+
+        size_type size() const { return (_list ? _list->size() : 0); }
+        bool empty() const { return (0 == size()); }
+        iterator begin() const { return (_list ? _list->begin() : iterator()); }
+        iterator end() const { return (_list ? _list->end() : iterator()); }
+        bool operator[](size_type i) const { return (*_list)[i]; }
+        bool front() const { return _list->front(); }
+        bool back() const { return _list->back(); }
+
+    };  // class span_t<const bool>
+
+    // 保存复制的字符串, 只追加, 已保存的字符串地址不变
+    class _text_pool_t
+    {
+        static constexpr size_type _block_size = 4096;
+
+        pmr::list_t<pmr::string_t> _blocks;
+
+    public:
+
+        explicit _text_pool_t(std::pmr::memory_resource* resource) : _blocks(resource) { }
+
+        std::string_view append(std::string_view text)
         {
-            return std::get<_Type>(_v_map.at(_k_map.at(key)));
+            if (_blocks.empty() || _blocks.back().capacity() - _blocks.back().size() < text.size())
+            {
+                pmr::string_t block(_blocks.get_allocator());
+                block.reserve(std::max(_block_size, text.size()));
+                _blocks.push_back(std::move(block));
+            }
+
+            pmr::string_t& block = _blocks.back();
+            size_type n = block.size();
+            block.append(text.data(), text.size());
+
+            return std::string_view(block.data() + n, text.size());
         }
 
+    };  // class _text_pool_t
+
+    // 序列化的解析结果: 头部、已出现参数的位图、定长的值表、列表、字符串数据和子命令的结果依次连续保存
+    // 整数使用本机字节序, 读取时逐个复制, 不要求对齐
+    struct _binary_t
+    {
+        static constexpr std::uint32_t magic = 0x52434658;     // "XFCR"
+        static constexpr std::uint16_t version = 1;
+
+        struct header_t
+        {
+            std::uint32_t magic;
+            std::uint16_t version;
+            std::uint16_t reserved;
+            std::uint32_t size;             // 包括子命令的结果在内的总长度
+            std::uint32_t state;
+            std::uint32_t error_id;
+            std::uint32_t bound;            // 位图的位数, 即参数 id 的上界
+            std::uint64_t error_index;
+            std::uint64_t error_source;
+            std::uint32_t slots;
+            std::uint32_t lists;
+            std::uint32_t text;             // 字符串数据的长度
+            std::uint32_t command;          // 子命令的结果的长度
+            std::uint32_t hint[4];          // 字符串在字符串数据中的位置和长度
+            std::uint32_t name[2];
+        };
+
+        struct slot_t
+        {
+            std::uint32_t id;
+            std::uint32_t source;
+            std::uint32_t list;             // 列表的位置加 1
+            std::uint8_t type;              // value_t, 字符串和自定义类型的值保存在字符串数据中
+            std::uint8_t reserved[3];
+            std::uint32_t key[2];
+            std::uint64_t value;            // 数值, 或者字符串的位置(低 32 位)和长度(高 32 位)
+        };
+
+        static_assert(sizeof(header_t) == 80 && sizeof(slot_t) == 32, "unexpected padding.");
+
         template<typename _Type>
-        _Type get(const string_t& key, const _Type& value) const
+        static void put(string_t& out, const _Type& x)
         {
-            try {
-                return get<_Type>(key);
-            } catch (const std::exception& /* e */) {
-                // std::cout << e.what() << std::endl;
-                return value;
+            out.append(reinterpret_cast<const char*>(&x), sizeof(_Type));
+        }
+
+        [[noreturn]] static void fail(const char* what)
+        {
+            throw std::invalid_argument(string_t("invalid serialized result: ") + what + ".");
+        }
+
+        class reader_t
+        {
+            std::string_view _data;
+            size_type _pos{ 0 };
+
+        public:
+
+            explicit reader_t(std::string_view data) : _data(data) { }
+
+            template<typename _Type>
+            void get(_Type& x)
+            {
+                if (_data.size() - _pos < sizeof(_Type))
+                    fail("truncated data");
+
+                std::memcpy(&x, _data.data() + _pos, sizeof(_Type));
+                _pos += sizeof(_Type);
             }
+
+            size_type position() const { return _pos; }
+            void skip(size_type n) { if (_data.size() - _pos < n) fail("truncated data"); _pos += n; }
+
+            // 预留空间前确认数据中至少还有 n 个 size 字节的元素
+            void expect(std::uint64_t n, size_type size) const { if ((_data.size() - _pos) / size < n) fail("truncated data"); }
+        };
+
+        static std::string_view text(std::string_view data, std::uint64_t pos, std::uint64_t n)
+        {
+            if (data.size() < pos || data.size() - pos < n)
+                fail("string out of range");
+
+            return data.substr(static_cast<size_type>(pos), static_cast<size_type>(n));
         }
+    };  // struct _binary_t
 
-        const map_t<string_t, variant_t>& get() const { return _v_map; }
+    class result_t
+    {
+        friend class Parser;
 
-        map_t<string_t, string_t> args() const
+        using id_type = _key_index_t::id_type;
+        using variant_t = std::variant<std::nullptr_t, bool, int, unsigned int, double, string_t>;
+
+        // 内部存储的值, 借用输入参数时字符串值保存为 string_view, 否则使用解析时指定的 memory_resource
+        using _value_t = std::variant<std::nullptr_t, bool, int, unsigned int, double, pmr::string_t, std::string_view, _custom_t>;
+
+        static string_t _to_string(const _value_t& v)
         {
-            map_t<string_t, string_t> mss;
-            for (auto v : _v_map)
-                mss.emplace(v.first, _to_string(v.second));
+            string_t x;
+            std::visit([&](auto&& t) mutable { x = xf::cmd::_to_string(t); }, v);
+            return x;
+        }
 
-            return mss;
+        static variant_t _to_variant(const _value_t& v)
+        {
+            return std::visit([](auto&& t) -> variant_t {
+                using _Type = std::decay_t<decltype(t)>;
+                if constexpr (std::is_same_v<_Type, std::string_view> || std::is_same_v<_Type, pmr::string_t>)
+                    return string_t(t);
+                else if constexpr (std::is_same_v<_Type, _custom_t>)
+                    return t.to_string();
+                else
+                    return t;
+            }, v);
         }
 
-    private:
+        template<typename _Type>
+        static _Type _value_cast(const _value_t& v)
+        {
+            if constexpr (std::is_same_v<_Type, string_t>)
+            {
+                if (auto p = std::get_if<std::string_view>(&v)) return string_t(*p);
+                return string_t(std::get<pmr::string_t>(v));
+            }
+            else if constexpr (std::is_same_v<_Type, std::string_view>)
+            {
+                if (auto p = std::get_if<pmr::string_t>(&v)) return *p;
+                return std::get<std::string_view>(v);
+            }
+            else if constexpr (value_t::vt_custom == _type_mapper<_Type>::_value)
+            {
+                if (auto p = std::get<_custom_t>(v).get<_Type>()) return *p;
+                throw std::bad_variant_access();
+            }
+            else
+            {
+                return std::get<_Type>(v);
+            }
+        }
+
+        struct _slot_t
+        {
+            id_type id;
+            std::string_view key;   // 命令行中使用的参数名, 指向参数名索引中保存的字符串, 恢复的结果中指向恢复的字符串
+            _value_t value;
+            unsigned int list{ 0 }; // 可以重复的参数的值在 _lists 中的位置加 1
+            unsigned int source{ 0 };   // 值所在的来源
+        };
+
+        // Reparse 使用的解析记录: 所有参数, 每个参数处理后的状态, 以及处理期间的参数检查和添加的值
+        struct _trace_t
+        {
+            struct step_t
+            {
+                size_type state;
+                id_type id;             // 等待值的参数
+                std::string_view key;
+                size_type actions;      // 处理后 actions 的数量
+                size_type values;       // 处理后 _values 的数量
+                bool unique;
+            };
+
+            struct action_t
+            {
+                id_type id;
+                std::string_view key;
+                size_type slot;         // 添加的值在 _values 中的位置, npos 表示参数检查
+            };
+
+            string_t text;
+            list_t<size_type> ends;
+            list_t<step_t> steps;
+            list_t<action_t> actions;
+            bool checked{ false };      // 通过了必需参数的检查
+            std::uint64_t revision{ 0 };    // 解析时参数表的版本号
+
+            size_type size() const { return ends.size(); }
+
+            std::string_view token(size_type i) const
+            {
+                size_type b = (i ? ends[i - 1] : 0);
+                return std::string_view(text).substr(b, ends[i] - b);
+            }
+        };
+
+        // 可以重复的参数的值, 每个参数一组
+        using _list_t = std::variant<pmr::list_t<bool>, pmr::list_t<int>, pmr::list_t<unsigned int>, pmr::list_t<double>, pmr::list_t<std::string_view>>;
+
+        // 出错时只记录状态和出错的参数, info() 和 hint() 的文本在第一次使用时生成
+        state_t _state;
+        mutable string_t _info;
+        mutable pair_t<string_t, string_t> _extra;
+        std::string_view _error[2];             // 借用模式下出错的参数, 不复制
+        mutable bool _error_borrowed{ false };
+        size_type _error_index;
+        id_type _error_id{ 0 };
+        size_type _cursor{ 0 };                 // 正在解析的参数的位置
+        unsigned int _source{ 0 };              // 正在解析的来源
+        size_type _source_begin{ 0 };           // 当前来源的第一个值在 _values 中的位置
+        size_type _error_source{ 0 };
+        void* _target{ nullptr };               // ParseInto 的目标结构体
+        const void* _target_type{ nullptr };
+        std::shared_ptr<const _key_index_t> _index;
+        pmr::list_t<_slot_t> _values;           // 按出现的顺序保存
+        pmr::list_t<unsigned int> _position;    // id -> 在 _values 中的位置
+        pmr::list_t<std::uint64_t> _present;    // 已出现参数的 id 位图
+        pmr::list_t<_list_t> _lists;
+        std::shared_ptr<_text_pool_t> _pool;    // 非借用模式下列表中的字符串, 复制结果时共享, 不使用解析时指定的 memory_resource
+        std::shared_ptr<_trace_t> _trace;       // 只在 Reparse 中记录
+        pmr::string_t _command;                 // 选中的子命令
+        std::shared_ptr<const result_t> _command_result;
+        bool _is_unique{ false };
+        bool _is_borrowed{ false };
+
+        explicit result_t(state_t code) : _state(code), _error_index(npos) { }
+
+        result_t(const std::shared_ptr<const _key_index_t>& index, size_type n, bool borrowed, std::pmr::memory_resource* resource)
+            : _state(state_t::s_ok), _error_index(npos), _index(index), _values(resource)
+            , _position(index->bound(), 0, resource), _present((index->bound() + 63) / 64, 0, resource), _lists(resource), _command(resource), _is_borrowed(borrowed)
+        {
+            _values.reserve(n);
+        }
+
+    public:
+
+        static constexpr size_type npos = size_type(-1);
+
+        result_t() : result_t(state_t::s_nothing) { }
+
+        state_t code() const { return _state; }
+
+        // 文本在第一次调用时生成, 多个线程第一次访问同一个结果时需要同步
+        const string_t& info() const
+        {
+            if (_info.empty())
+                _info = _make_info(_state, _hint(0), _hint(1));
+
+            return _info;
+        }
+
+        const pair_t<string_t, string_t>& hint() const
+        {
+            if (_error_borrowed)
+            {
+                _extra.first.assign(_error[0].data(), _error[0].size());
+                _extra.second.assign(_error[1].data(), _error[1].size());
+                _error_borrowed = false;
+            }
+
+            return _extra;
+        }
+
+        // 出错的参数在输入中的位置(响应文件中的错误对应'@'参数的位置), 不能确定时为 npos
+        size_type error_index() const { return _error_index; }
+
+        // 出错的参数对应的 id, 可以与 handle_t::id() 比较, 不能确定时为 0
+        unsigned int error_id() const { return _error_id; }
+
+        // 出错的参数所在的来源, 参见 Parser::ParseLayers
+        size_type error_source() const { return _error_source; }
+
+        // 参数的值所在的来源, 参数不存在时为 npos
+        size_type source(const string_t& key) const { return _source_of(_find(key)); }
+
+        template<typename _Type>
+        size_type source(const handle_t<_Type>& h) const { return _source_of(h._id); }
+
+        // 选中的子命令及其参数的解析结果, 没有子命令时分别为空和 s_nothing, 参见 Parser::AddCommand
+        std::string_view command() const { return _command; }
+
+        const result_t& command_result() const
+        {
+            static const result_t nothing;
+            return (_command_result ? *_command_result : nothing);
+        }
+        bool is_valid() const { return (state_t::s_ok == code()); }
+        bool is_existing(const string_t& key) const { return _test(_find(key)); }
+
+        operator bool() const { return is_valid(); }
+        operator const string_t& () const { return info(); }
+
+        bool has_value(const string_t& key) const { return _has_value(_find(key)); }
+
+        template<typename _Type>
+        _Type get(const string_t& key) const
+        {
+            id_type id = _find(key);
+            if (!_test(id))
+                throw std::out_of_range(R"(parameter ")" + key + R"(" not found.)");
+
+            return _value_cast<_Type>(_slot(id).value);
+        }
+
+        template<typename _Type>
+        _Type get(const string_t& key, const _Type& value) const
+        {
+            try {
+                return get<_Type>(key);
+            } catch (const std::exception& /* e */) {
+                // std::cout << e.what() << std::endl;
+                return value;
+            }
+        }
+
+        template<typename _Type>
+        bool is_existing(const handle_t<_Type>& h) const { return _test(h._id); }
+
+        template<typename _Type>
+        bool has_value(const handle_t<_Type>& h) const { return _has_value(h._id); }
+
+        template<typename _Type>
+        _Type get(const handle_t<_Type>& h) const
+        {
+            if (!_test(h._id))
+                throw std::out_of_range("parameter not found.");
+
+            return _value_cast<_Type>(_slot(h._id).value);
+        }
+
+        template<typename _Type>
+        _Type get(const handle_t<_Type>& h, const _Type& value) const
+        {
+            if (has_value(h))
+            {
+                try {
+                    return get(h);
+                } catch (const std::exception& /* e */) {
+                }
+            }
+
+            return value;
+        }
+
+        // 可以重复的参数的所有值, 字符串类型使用 std::string_view, 参数不存在时为空
+        template<typename _Type>
+        span_t<const _Type> get_list(const string_t& key) const { return _get_list<_Type>(_find(key)); }
+
+        template<typename _Type>
+        auto get_list(const handle_t<_Type>& h) const
+        {
+            return _get_list<std::conditional_t<std::is_same_v<_Type, string_t>, std::string_view, _Type>>(h._id);
+        }
+
+        map_t<string_t, variant_t> get() const
+        {
+            map_t<string_t, variant_t> msv;
+            for (auto& v : _values)
+                msv.emplace(v.key, _to_variant(v.value));
+
+            return msv;
+        }
+
+        map_t<string_t, string_t> args() const
+        {
+            map_t<string_t, string_t> mss;
+            for (auto& v : _values)
+                mss.emplace(v.key, v.list ? _to_string(_lists[v.list - 1]) : _to_string(v.value));
+
+            return mss;
+        }
+
+        // 序列化为一段连续的数据, 由参数表相同的 Parser::Deserialize 或 DeserializeView 恢复, 用于把解析结果交给其他进程
+        // 包括参数、值、来源、错误和子命令的结果; 自定义类型的值通过 converter_t::to_string 保存, 恢复时重新转换
+        // 自定义类型没有提供 to_string 时无法恢复, 抛出 std::invalid_argument
+        string_t serialize() const
+        {
+            string_t text;
+            auto ref = [&text](std::string_view v, std::uint32_t* x) {
+                x[0] = static_cast<std::uint32_t>(text.size());
+                x[1] = static_cast<std::uint32_t>(v.size());
+                text.append(v.data(), v.size());
+            };
+
+            string_t sub(_command_result ? _command_result->serialize() : string_t());
+
+            _binary_t::header_t h{};
+            h.magic = _binary_t::magic;
+            h.version = _binary_t::version;
+            h.state = static_cast<std::uint32_t>(_state);
+            h.error_id = _error_id;
+            h.bound = static_cast<std::uint32_t>(_position.size());
+            h.error_index = _error_index;
+            h.error_source = _error_source;
+            h.slots = static_cast<std::uint32_t>(_values.size());
+            h.lists = static_cast<std::uint32_t>(_lists.size());
+            h.command = static_cast<std::uint32_t>(sub.size());
+            ref(_hint(0), h.hint);
+            ref(_hint(1), h.hint + 2);
+            ref(_command, h.name);
+
+            // 头部在长度确定后写入
+            string_t out(sizeof(h), '\0');
+            out.reserve(sizeof(h) + _present.size() * sizeof(std::uint64_t) + _values.size() * sizeof(_binary_t::slot_t));
+            for (auto w : _present)
+                _binary_t::put(out, w);
+
+            for (auto& v : _values)
+            {
+                _binary_t::slot_t slot{};
+                slot.id = v.id;
+                slot.source = v.source;
+                slot.list = v.list;
+                ref(v.key, slot.key);
+
+                std::visit([&](auto& x) {
+                    using _Type = std::decay_t<decltype(x)>;
+                    if constexpr (std::is_same_v<_Type, std::nullptr_t>)
+                    {
+                        slot.type = static_cast<std::uint8_t>(value_t::vt_nothing);
+                    }
+                    else if constexpr (std::is_same_v<_Type, pmr::string_t> || std::is_same_v<_Type, std::string_view> || std::is_same_v<_Type, _custom_t>)
+                    {
+                        std::uint32_t t[2];
+                        if constexpr (std::is_same_v<_Type, _custom_t>)
+                        {
+                            if (!x.is_printable())
+                                throw std::invalid_argument(R"(the value of parameter ")" + string_t(v.key) + R"(" can't be serialized without converter_t::to_string.)");
+                            ref(x.to_string(), t);
+                        }
+                        else
+                            ref(x, t);
+
+                        slot.type = static_cast<std::uint8_t>(std::is_same_v<_Type, _custom_t> ? value_t::vt_custom : value_t::vt_string);
+                        slot.value = t[0] | (std::uint64_t(t[1]) << 32);
+                    }
+                    else
+                    {
+                        slot.type = static_cast<std::uint8_t>(_type_mapper<_Type>::_value);
+                        if constexpr (std::is_same_v<_Type, double>)
+                            std::memcpy(&slot.value, &x, sizeof(x));
+                        else if constexpr (std::is_same_v<_Type, int>)
+                            slot.value = static_cast<std::uint64_t>(static_cast<std::int64_t>(x));
+                        else
+                            slot.value = static_cast<std::uint64_t>(x);
+                    }
+                }, v.value);
+
+                _binary_t::put(out, slot);
+            }
+
+            // 每个列表: 值的类型(_list_t 的下标)和数量, 之后是所有值, 字符串保存位置和长度
+            for (auto& list : _lists)
+            {
+                _binary_t::put(out, static_cast<std::uint32_t>(list.index()));
+                std::visit([&](auto& values) {
+                    using _Type = typename std::decay_t<decltype(values)>::value_type;
+                    _binary_t::put(out, static_cast<std::uint32_t>(values.size()));
+                    for (auto x : values)
+                    {
+                        if constexpr (std::is_same_v<_Type, std::string_view>)
+                        {
+                            std::uint32_t t[2];
+                            ref(x, t);
+                            _binary_t::put(out, t);
+                        }
+                        else if constexpr (std::is_same_v<_Type, bool>)
+                        {
+                            _binary_t::put(out, static_cast<std::uint8_t>(x));
+                        }
+                        else
+                        {
+                            _binary_t::put(out, x);
+                        }
+                    }
+                }, list);
+            }
+
+            h.text = static_cast<std::uint32_t>(text.size());
+            out += text;
+            out += sub;
+            h.size = static_cast<std::uint32_t>(out.size());
+            std::memcpy(&out[0], &h, sizeof(h));
+
+            return out;
+        }
+
+    private:
+
+        id_type _find(std::string_view key) const { return (_index ? _index->find(key) : 0); }
+
+        bool _test(id_type id) const
+        {
+            return (id < _position.size() && 0 != ((_present[id / 64] >> (id % 64)) & 1));
+        }
+
+        const _slot_t& _slot(id_type id) const { return _values[_position[id]]; }
+
+        size_type _source_of(id_type id) const { return (_test(id) ? _slot(id).source : npos); }
+
+        bool _has_value(id_type id) const
+        {
+            if (!_test(id)) return false;
+
+            const _slot_t& slot = _slot(id);
+            if (slot.list)
+                return std::visit([](auto& x) { return !x.empty(); }, _lists[slot.list - 1]);
+
+            return (static_cast<size_type>(value_t::vt_nothing) != slot.value.index());
+        }
+
+        template<typename _Type>
+        span_t<const _Type> _get_list(id_type id) const
+        {
+            if (!_test(id) || 0 == _slot(id).list)
+                return span_t<const _Type>();
+
+            const auto& list = std::get<pmr::list_t<_Type>>(_lists[_slot(id).list - 1]);
+            if constexpr (std::is_same_v<_Type, bool>)
+                return span_t<const bool>(&list);
+            else
+                return span_t<const _Type>(list.data(), list.size());
+        }
+
+        static string_t _to_string(const _list_t& list)
+        {
+            string_t x;
+            std::visit([&](auto& v) {
+                for (auto t : v)
+                {
+                    if (!x.empty()) x += ',';
+                    x += xf::cmd::_to_string(t);
+                }
+            }, list);
+
+            return x;
+        }
+
+        // 复制的结果共享字符串池, 池必须在 arena 释放后仍然有效, 因此总是使用默认的内存分配
+        static std::shared_ptr<_text_pool_t> _make_pool()
+        {
+            return std::make_shared<_text_pool_t>(std::pmr::get_default_resource());
+        }
+
+        // 子命令的结果被复制的结果共享, 使用 arena 时复制一份, 复制的结果使用默认的内存分配
+        static std::shared_ptr<const result_t> _share(result_t&& sub, std::pmr::memory_resource* resource)
+        {
+            if (resource->is_equal(*std::pmr::get_default_resource()))
+                return std::make_shared<const result_t>(std::move(sub));
+
+            return std::make_shared<const result_t>(static_cast<const result_t&>(sub));
+        }
+
+        // 在多个线程之间共享之前生成错误文本, 之后只读
+        void _prepare() const
+        {
+            info();
+            hint();
+            if (_command_result)
+                _command_result->_prepare();
+        }
+
+        std::string_view _hint(size_type i) const
+        {
+            return (_error_borrowed ? _error[i] : std::string_view(i ? _extra.second : _extra.first));
+        }
+
+        // 借用模式下不复制出错的参数, 错误路径上没有内存分配
+        void _set_error(state_t s, id_type id, std::string_view a = std::string_view(), std::string_view b = std::string_view())
+        {
+            _state = s;
+            _error_id = id;
+            _error_index = _cursor;
+            _error_source = _source;
+            _info.clear();
+
+            if (_is_borrowed)
+            {
+                _error[0] = a;
+                _error[1] = b;
+                _error_borrowed = true;
+            }
+            else
+            {
+                _extra.first.assign(a.data(), a.size());
+                _extra.second.assign(b.data(), b.size());
+                _error_borrowed = false;
+            }
+        }
+
+        // 子命令的参数出错时, 错误的位置换算为在全部参数中的位置, error_id 对应子命令的参数
+        void _adopt_error(const result_t& sub, size_type offset)
+        {
+            _state = sub._state;
+            _error_id = sub._error_id;
+            _error_index = (npos == sub._error_index ? npos : offset + sub._error_index);
+            _error_source = _source;
+            _error[0] = sub._error[0];
+            _error[1] = sub._error[1];
+            _error_borrowed = sub._error_borrowed;
+            _extra = sub._extra;
+            _info.clear();
+        }
+
+        // 已经由优先级更高的来源指定, 当前来源中的这个参数及其值被忽略
+        bool _is_overridden(id_type id, const option_t& opt) const
+        {
+            return ((_test(id) && _slot(id).source != _source) || (opt.is_unique() && 0 < _source_begin));
+        }
+
+        // 唯一性和重复只在同一个来源中检查
+        bool _check_key(id_type id, std::string_view key, const option_t& opt)
+        {
+            if (_trace)
+                _trace->actions.push_back({ id, key, npos });
+
+            if (_values.size() == _source_begin)
+            {
+                if (opt.is_unique()) _is_unique = true;
+                return true;
+            }
+
+            if (_is_unique)
+            {
+                _set_error(state_t::s_k_conflict, _values[_source_begin].id, _values[_source_begin].key);
+                return false;
+            }
+
+            if (opt.is_unique())
+            {
+                _set_error(state_t::s_k_conflict, id, key);
+                return false;
+            }
+
+            if (_test(id) && !opt.is_multiple())
+            {
+                _set_error(state_t::s_k_duplicated, id, _slot(id).key, key);
+                return false;
+            }
+
+            return true;
+        }
+
+        template<typename _Type>
+        void _add_value(id_type id, std::string_view key, _Type&& value)
+        {
+            _present[id / 64] |= (std::uint64_t(1) << (id % 64));
+            _position[id] = static_cast<unsigned int>(_values.size());
+            _values.push_back({ id, key, _value_t(std::forward<_Type>(value)), 0, _source });
+
+            if (_trace)
+                _trace->actions.push_back({ id, key, _values.size() - 1 });
+        }
+
+        void _insert(const _slot_t& slot)
+        {
+            _present[slot.id / 64] |= (std::uint64_t(1) << (slot.id % 64));
+            _position[slot.id] = static_cast<unsigned int>(_values.size());
+            _values.push_back(slot);
+        }
+
+        template<typename _Type>
+        bool _convert_value(id_type id, std::string_view key, std::string_view value)
+        {
+            _Type x{};
+            if (!xf::cmd::_from_string(value, x))
+                return false;
+
+            _add_value(id, key, x);
+            return true;
+        }
+
+        bool _is_bound(const option_t& opt) const
+        {
+            return (nullptr != _target && opt._bind_type == _target_type);
+        }
+
+        // 绑定的参数值直接写入结构体, 结果中只记录参数是否出现
+        bool _bind_value(id_type id, std::string_view key, const std::string_view* value, const option_t& opt)
+        {
+            if (!opt._bind(_target, value))
+                return false;
+
+            if (!_test(id))
+                _add_value(id, key, nullptr);
+
+            return true;
+        }
+
+        // 第一次出现时创建对应类型的列表
+        _list_t& _open_list(id_type id, std::string_view key, const option_t& opt)
+        {
+            if (_test(id))
+                return _lists[_slot(id).list - 1];
+
+            auto alloc = _values.get_allocator();
+            switch (opt.value_type())
+            {
+            case value_t::vt_boolean:  _lists.emplace_back(pmr::list_t<bool>(alloc)); break;
+            case value_t::vt_integer:  _lists.emplace_back(pmr::list_t<int>(alloc)); break;
+            case value_t::vt_unsigned: _lists.emplace_back(pmr::list_t<unsigned int>(alloc)); break;
+            case value_t::vt_float:    _lists.emplace_back(pmr::list_t<double>(alloc)); break;
+            default:                   _lists.emplace_back(pmr::list_t<std::string_view>(alloc)); break;
+            }
+
+            _add_value(id, key, nullptr);
+            _values.back().list = static_cast<unsigned int>(_lists.size());
+
+            return _lists.back();
+        }
+
+        template<typename _Type>
+        bool _append_value(pmr::list_t<_Type>& list, std::string_view value)
+        {
+            if constexpr (std::is_same_v<_Type, std::string_view>)
+            {
+                if (value.empty())
+                    return false;
+
+                if (!_is_borrowed && !_pool)
+                    _pool = _make_pool();
+
+                list.push_back(_is_borrowed ? value : _pool->append(value));
+            }
+            else
+            {
+                _Type x{};
+                if (!xf::cmd::_from_string(value, x))
+                    return false;
+
+                list.push_back(x);
+            }
+
+            return true;
+        }
+
+        // 按分隔符拆分后逐个校验并追加
+        bool _append_values(id_type id, std::string_view key, std::string_view value, const option_t& opt)
+        {
+            return std::visit([&](auto& list) {
+                for (size_type i = 0; ; )
+                {
+                    size_type j = (opt.delimiter() ? value.find(opt.delimiter(), i) : std::string_view::npos);
+                    std::string_view x = value.substr(i, j - i);
+                    if (!(opt._is_builtin() || opt._check_value(x)) || !_append_value(list, x))
+                        return false;
+
+                    if (std::string_view::npos == j)
+                        return true;
+
+                    i = j + 1;
+                }
+            }, _open_list(id, key, opt));
+        }
+
+        bool _add_value(id_type id, std::string_view key, std::string_view value, const option_t& opt)
+        {
+            if (_is_bound(opt))
+                return _bind_value(id, key, &value, opt);
+
+            if (opt.is_multiple() && value_t::vt_nothing != opt.value_type())
+                return _append_values(id, key, value, opt);
+
+            switch (opt.value_type())
+            {
+            case value_t::vt_custom:
+            {
+                _custom_t x;
+                if (!opt._convert || !opt._convert(value, x))
+                    return false;
+                _add_value(id, key, std::move(x));
+                return true;
+            }
+            case value_t::vt_string:
+                if (value.empty())
+                    return false;
+                if (_is_borrowed)
+                    _add_value(id, key, value);
+                else
+                    _add_value(id, key, pmr::string_t(value, _values.get_allocator()));
+                return true;
+            case value_t::vt_boolean:
+                return _convert_value<bool>(id, key, value);
+            case value_t::vt_float:
+                return _convert_value<double>(id, key, value);
+            case value_t::vt_integer:
+                return _convert_value<int>(id, key, value);
+            case value_t::vt_unsigned:
+                return _convert_value<unsigned int>(id, key, value);
+            case value_t::vt_nothing:
+                _add_value(id, key, nullptr);
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        void _add_value(id_type id, std::string_view key, const option_t& opt)
+        {
+            if (_is_bound(opt))
+                _bind_value(id, key, nullptr, opt);
+            else if (opt.is_multiple() && value_t::vt_nothing != opt.value_type())
+                _open_list(id, key, opt);
+            else if (!_test(id))
+                _add_value(id, key, nullptr);
+        }
+
+    };  // class result_t
+
+    // 解析过程的统计快照, 参见 Parser::EnableMetrics
+    struct metrics_t
+    {
+        struct option_stats_t
+        {
+            set_t<string_t> keys;
+            std::uint64_t hits{ 0 };        // 参数出现的次数
+            std::uint64_t failures{ 0 };    // 参数值校验或者转换失败的次数
+        };
+
+        std::uint64_t parses{ 0 };
+        std::array<std::uint64_t, state_t::s_f_error + 1> states{};     // 按 state_t 统计的解析结果
+
+        // 以下只在开启计时后统计, 单位为纳秒
+        std::uint64_t match_ns{ 0 };        // 参数名匹配
+        std::uint64_t check_ns{ 0 };        // 自定义校验(option_t::check 和模式)
+        std::uint64_t convert_ns{ 0 };      // 保存参数值, 包括内置类型的校验与转换
+        std::uint64_t total_ns{ 0 };
+        std::array<std::uint64_t, 64> latency{};    // latency[i] 为耗时在 [2^i, 2^(i+1)) 纳秒之间的解析次数
+
+        list_t<option_stats_t> options;     // 按参数添加的顺序
+    };
+
+    // 每次解析结束时调用, 可以用于自定义的延迟直方图
+    using latency_hook_t = std::function<void (state_t state, std::chrono::nanoseconds latency)>;
+
+    // 解析过程的计数器, 多个线程可以同时更新
+    class _metrics_t
+    {
+        using _counter_type = std::atomic<std::uint64_t>;
+
+        struct _option_type
+        {
+            _counter_type hits;
+            _counter_type failures;
+        };
+
+        _counter_type _parses;
+        std::array<_counter_type, state_t::s_f_error + 1> _states;
+        std::array<_counter_type, 4> _phases;
+        std::array<_counter_type, 64> _latency;
+
+        // 参数的计数器按 id 分段, 第 k 段有 64 << k 个, 用到时才分配, 之后添加的参数也能计数
+        static constexpr size_type _segment_base = 64;
+        std::array<std::atomic<_option_type*>, 32> _segments;
+
+        static void _add(_counter_type& c, std::uint64_t n = 1) { c.fetch_add(n, std::memory_order_relaxed); }
+        static std::uint64_t _load(const _counter_type& c) { return c.load(std::memory_order_relaxed); }
+
+        static size_type _segment_size(size_type k) { return (_segment_base << k); }
+
+        static bool _locate(size_type id, size_type& k, size_type& offset)
+        {
+            size_type n = id / _segment_base + 1;
+            for (k = 0; 1 < n; n >>= 1) ++k;
+
+            if (k >= std::tuple_size<decltype(_segments)>::value)
+                return false;
+
+            offset = id - _segment_base * ((size_type(1) << k) - 1);
+            return true;
+        }
+
+        _option_type* _find(size_type id) const
+        {
+            size_type k, offset;
+            if (!_locate(id, k, offset))
+                return nullptr;
+
+            _option_type* segment = _segments[k].load(std::memory_order_acquire);
+            return (segment ? segment + offset : nullptr);
+        }
+
+        _option_type* _get(size_type id)
+        {
+            size_type k, offset;
+            if (!_locate(id, k, offset))
+                return nullptr;
+
+            _option_type* segment = _segments[k].load(std::memory_order_acquire);
+            if (!segment)
+            {
+                _option_type* created = _allocate(k);
+                if (_segments[k].compare_exchange_strong(segment, created, std::memory_order_acq_rel, std::memory_order_acquire))
+                    segment = created;
+                else
+                    delete[] created;
+            }
+
+            return (segment + offset);
+        }
+
+        static _option_type* _allocate(size_type k)
+        {
+            _option_type* segment = new _option_type[_segment_size(k)];
+            for (size_type i = 0; i < _segment_size(k); ++i)
+            {
+                segment[i].hits.store(0, std::memory_order_relaxed);
+                segment[i].failures.store(0, std::memory_order_relaxed);
+            }
+
+            return segment;
+        }
+
+    public:
+
+        using clock_type = std::chrono::steady_clock;
+
+        enum phase_t { p_match, p_check, p_convert, p_total };
+
+        const bool timing;
+        const latency_hook_t hook;
+
+        // 预先分配前 n 个参数的计数器
+        _metrics_t(size_type n, bool t, latency_hook_t h)
+            : timing(t || h), hook(std::move(h))
+        {
+            for (auto& segment : _segments) segment.store(nullptr, std::memory_order_relaxed);
+            reset();
+
+            size_type last = 0, offset;
+            if (0 < n && _locate(n - 1, last, offset))
+            {
+                for (size_type k = 0; k <= last; ++k)
+                    _segments[k].store(_allocate(k), std::memory_order_relaxed);
+            }
+        }
+
+        ~_metrics_t()
+        {
+            for (auto& segment : _segments) delete[] segment.load(std::memory_order_relaxed);
+        }
+
+        void reset()
+        {
+            _parses.store(0, std::memory_order_relaxed);
+            for (auto& c : _states) c.store(0, std::memory_order_relaxed);
+            for (auto& c : _phases) c.store(0, std::memory_order_relaxed);
+            for (auto& c : _latency) c.store(0, std::memory_order_relaxed);
+            for (size_type k = 0; k < _segments.size(); ++k)
+            {
+                _option_type* segment = _segments[k].load(std::memory_order_acquire);
+                for (size_type i = 0; segment && i < _segment_size(k); ++i)
+                {
+                    segment[i].hits.store(0, std::memory_order_relaxed);
+                    segment[i].failures.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void hit(size_type id) { if (auto c = _get(id)) _add(c->hits); }
+        void fail(size_type id) { if (auto c = _get(id)) _add(c->failures); }
+
+        void add(phase_t phase, clock_type::time_point start)
+        {
+            _add(_phases[phase], static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count()));
+        }
+
+        void finish(state_t state, clock_type::time_point start)
+        {
+            _add(_parses);
+            _add(_states[state]);
+            if (!timing)
+                return;
+
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start);
+            auto n = static_cast<std::uint64_t>(ns.count());
+            _add(_phases[p_total], n);
+
+            size_type bucket = 0;
+            for (; 1 < n; n >>= 1) ++bucket;
+            _add(_latency[bucket]);
+
+            if (hook)
+                hook(state, ns);
+        }
+
+        std::uint64_t hits(size_type id) const { auto c = _find(id); return (c ? _load(c->hits) : 0); }
+        std::uint64_t failures(size_type id) const { auto c = _find(id); return (c ? _load(c->failures) : 0); }
+
+        void snapshot(metrics_t& m) const
+        {
+            m.parses = _load(_parses);
+            for (size_type i = 0; i < _states.size(); ++i) m.states[i] = _load(_states[i]);
+            for (size_type i = 0; i < _latency.size(); ++i) m.latency[i] = _load(_latency[i]);
+            m.match_ns = _load(_phases[p_match]);
+            m.check_ns = _load(_phases[p_check]);
+            m.convert_ns = _load(_phases[p_convert]);
+            m.total_ns = _load(_phases[p_total]);
+        }
+
+    };  // class _metrics_t
+
+    // 解析结果缓存的统计, 参见 Parser::EnableCache
+    struct cache_stats_t
+    {
+        std::uint64_t hits{ 0 };
+        std::uint64_t misses{ 0 };
+        std::uint64_t evictions{ 0 };
+        std::uint64_t invalidations{ 0 };   // 修改参数表导致缓存清空的次数
+        size_type size{ 0 };
+        size_type capacity{ 0 };
+    };
+
+    // 解析结果的缓存: 按参数的哈希查找, 容量固定, 使用 CLOCK 淘汰
+    // 查找只加共享锁, 命中时设置引用位; 插入和淘汰加独占锁
+    class _cache_t
+    {
+        struct _entry_t
+        {
+            size_type hash{ 0 };
+            list_t<string_t> args;
+            std::shared_ptr<const result_t> result;
+            std::atomic<bool> referenced{ false };
+        };
+
+        using _counter_type = std::atomic<std::uint64_t>;
+
+        mutable std::shared_mutex _mutex;
+        std::unique_ptr<_entry_t[]> _entries;
+        std::unordered_map<size_type, size_type> _index;   // 哈希 -> 在 _entries 中的位置
+        const size_type _capacity;
+        size_type _size{ 0 };
+        size_type _hand{ 0 };
+        _counter_type _hits{ 0 };
+        _counter_type _misses{ 0 };
+        _counter_type _evictions{ 0 };
+        const std::uint64_t _invalidations{ 0 };
+
+        static void _add(_counter_type& c) { c.fetch_add(1, std::memory_order_relaxed); }
+        static std::uint64_t _load(const _counter_type& c) { return c.load(std::memory_order_relaxed); }
+
+    public:
+
+        // 参数表修改后的缓存为空, 计数从 previous 延续
+        _cache_t(size_type capacity, const _cache_t* previous = nullptr)
+            : _entries(new _entry_t[capacity]), _capacity(capacity), _invalidations(previous ? previous->_invalidations + 1 : 0)
+        {
+            _index.reserve(capacity);
+            if (previous)
+            {
+                _hits.store(_load(previous->_hits), std::memory_order_relaxed);
+                _misses.store(_load(previous->_misses), std::memory_order_relaxed);
+                _evictions.store(_load(previous->_evictions), std::memory_order_relaxed);
+            }
+        }
+
+        size_type capacity() const { return _capacity; }
+
+        // 逐个参数计算哈希后按顺序合并, 参数的边界不同时哈希不同({ "ab" } 与 { "a", "b" })
+        template<typename _IterType>
+        static size_type hash(_IterType first, _IterType last)
+        {
+            size_type h = 0;
+            for (; first != last; ++first)
+                h = (h ^ std::hash<std::string_view>()(std::string_view(*first))) * static_cast<size_type>(0x9E3779B97F4A7C15ull) + 1;
+
+            return h;
+        }
+
+        template<typename _IterType>
+        std::shared_ptr<const result_t> find(size_type h, _IterType first, _IterType last)
+        {
+            std::shared_lock<std::shared_mutex> lock(_mutex);
+            auto iter = _index.find(h);
+            if (iter != _index.end())
+            {
+                _entry_t& e = _entries[iter->second];
+                if (std::equal(e.args.begin(), e.args.end(), first, last, [](const string_t& a, const auto& b) { return std::string_view(a) == std::string_view(b); }))
+                {
+                    e.referenced.store(true, std::memory_order_relaxed);
+                    _add(_hits);
+                    return e.result;
+                }
+            }
+
+            _add(_misses);
+            return nullptr;
+        }
+
+        // 哈希相同的项(包括其他线程刚刚插入的相同参数)直接替换
+        template<typename _IterType>
+        void insert(size_type h, _IterType first, _IterType last, std::shared_ptr<const result_t> result)
+        {
+            std::unique_lock<std::shared_mutex> lock(_mutex);
+            size_type slot = 0;
+            auto iter = _index.find(h);
+            if (iter != _index.end())
+            {
+                slot = iter->second;
+            }
+            else if (_size < _capacity)
+            {
+                slot = _size++;
+            }
+            else
+            {
+                // 跳过最近命中过的项并清除其引用位, 淘汰第一个没有被命中的项
+                while (_entries[_hand].referenced.exchange(false, std::memory_order_relaxed))
+                    _hand = (_hand + 1) % _capacity;
+
+                slot = _hand;
+                _hand = (_hand + 1) % _capacity;
+                _index.erase(_entries[slot].hash);
+                _add(_evictions);
+            }
+
+            _entry_t& e = _entries[slot];
+            e.hash = h;
+            e.args.assign(first, last);
+            e.result = std::move(result);
+            e.referenced.store(false, std::memory_order_relaxed);
+            _index[h] = slot;
+        }
+
+        cache_stats_t stats() const
+        {
+            std::shared_lock<std::shared_mutex> lock(_mutex);
+            return { _load(_hits), _load(_misses), _load(_evictions), _invalidations, _size, _capacity };
+        }
+
+    };  // class _cache_t
+
+    class FrozenParser;
+
+    class Parser
+    {
+        friend class FrozenParser;
+
+    public:
+
+        Parser() = default;
+
+        Parser(const list_t<pair_t<set_t<string_t>, option_t>>& options)
+        {
+            for (auto opt : options) AddOption(opt);
+        }
+
+        Parser& AddOption(const pair_t<set_t<string_t>, option_t>& option)
+        {
+            if (!option.first.empty())
+            {
+                _update_option_id();
+                _Modified();
+
+                opt_map.emplace(option_id, option);
+                if (option.second.is_key_required())
+                    _SetBit(required_mask, option_id);
+
+                for (auto key : option.first)
+                {
+                    auto iter = key_map.find(key);
+                    if (iter != key_map.end())
+                    {
+                        _RemoveOption(iter->second, key);
+                        iter->second = option_id;
+                    }
+                    else
+                    {
+                        key_map.emplace(key, option_id);
+                    }
+
+                    _Index().insert(key, option_id);
+                }
+            }
+
+            return *this;
+        }
+
+        size_type RemoveOption(const set_t<string_t>& keys)
+        {
+            size_type n = 0;
+            for (auto key : keys)
+            {
+                auto iter = key_map.find(key);
+                if (iter != key_map.end())
+                {
+                    _RemoveOption(iter->second, key);
+                    key_map.erase(iter);
+                    _Index().erase(key);
+                    ++n;
+                }
+            }
+
+            if (0 < n)
+                _Modified();
+
+            return n;
+        }
+
+        // 参数之间的约束, 添加时按参数的 id 编译为位图, 解析成功后与出现的参数的位图比较
+        // 不存在的参数被忽略, 约束只对添加时已有的参数有效; 出现唯一性参数时不检查约束
+        // 一组参数中最多出现一个, 否则为 s_k_conflict
+        Parser& AddExclusive(const set_t<string_t>& keys)
+        {
+            return _AddConstraint(_constraint_type::c_exclusive, 0, keys);
+        }
+
+        // 一组参数中至少出现一个, 否则为 s_k_missing
+        Parser& AddAtLeastOne(const set_t<string_t>& keys)
+        {
+            return _AddConstraint(_constraint_type::c_at_least_one, 0, keys);
+        }
+
+        // 出现 key 时 keys 中的参数都必须出现, 否则为 s_k_missing
+        Parser& AddRequires(const string_t& key, const set_t<string_t>& keys)
+        {
+            auto iter = key_map.find(key);
+            return (iter != key_map.end() ? _AddConstraint(_constraint_type::c_requires, iter->second, keys) : *this);
+        }
+
+        bool IsValid(const string_t& key) const
+        {
+            return (key_map.find(key) != key_map.end());
+        }
+
+        bool IsSame(const string_t& k1, const string_t& k2) const
+        {
+            auto iter1 = key_map.find(k1);
+            if (iter1 == key_map.end()) return false;
+
+            auto iter2 = key_map.find(k2);
+            if (iter2 == key_map.end()) return false;
+
+            return (iter1->second == iter2->second);
+        }
+
+        const option_t* GetOption(const string_t& key) const
+        {
+            auto iter = key_map.find(key);
+            if (iter != key_map.end())
+                return &opt_map.at(iter->second).second;
+
+            return nullptr;
+        }
+
+        set_t<string_t> GetKeys(const string_t& key) const
+        {
+            set_t<string_t> keys;
+            auto iter = key_map.find(key);
+            if (iter != key_map.end())
+                keys = opt_map.at(iter->second).first;
+
+            return keys;
+        }
+
+        template<typename _ValueType>
+        handle_t<_ValueType> GetHandle(const string_t& key) const
+        {
+            auto iter = key_map.find(key);
+            return handle_t<_ValueType>(iter != key_map.end() ? iter->second : 0);
+        }
+
+        template<typename _ValueType>
+        Parser& AddOption(const pair_t<set_t<string_t>, option_t>& option, handle_t<_ValueType>& handle)
+        {
+            AddOption(option);
+            handle = (option.first.empty() ? handle_t<_ValueType>() : handle_t<_ValueType>(option_id));
+            return *this;
+        }
+
+        // 将参数绑定到结构体的成员, 使用 ParseInto 解析时参数值按成员的类型转换后直接写入, 不保存在结果中
+        // 没有值的参数(vt_nothing)绑定到 bool 成员时, 出现即为 true
+        template<typename _StructType, typename _ValueType>
+        Parser& Bind(_ValueType _StructType::* member, const set_t<string_t>& keys, const option_t& option)
+        {
+            static_assert(value_t::vt_nothing != _type_mapper<_ValueType>::_value, "unsupported member type.");
+
+            _option_type opt{ keys, option };
+            opt.second._bind_type = &_type_tag<_StructType>::id;
+            opt.second._bind = [member](void* object, const std::string_view* value) {
+                _ValueType& x = static_cast<_StructType*>(object)->*member;
+                if (nullptr == value)
+                {
+                    if constexpr (std::is_same_v<_ValueType, bool>) x = true;
+                    return true;
+                }
+
+                if constexpr (std::is_same_v<_ValueType, string_t>)
+                {
+                    if (value->empty()) return false;
+                    x.assign(value->data(), value->size());
+                }
+                else
+                {
+                    _ValueType v{};
+                    if (!_convert(*value, v)) return false;
+                    x = std::move(v);
+                }
+
+                return true;
+            };
+
+            return AddOption(opt);
+        }
+
+        template<typename _StructType, typename _ValueType>
+        Parser& Bind(_ValueType _StructType::* member, const set_t<string_t>& keys, bool u = false, bool k = false, bool v = true)
+        {
+            return Bind(member, keys, option_t::make<_ValueType>(u, k, v));
+        }
+
+        set_t<string_t> GetKeys() const
+        {
+            set_t<string_t> keys;
+            for (auto v : key_map)
+                keys.emplace(v.first);
+
+            return keys;
+        }
+
+        FrozenParser Freeze() const;
+
+        // 开启后以'@'开头的参数被视为响应文件, 文件的内容按 shell 的规则切分后作为参数, 可以嵌套
+        Parser& EnableResponseFile(bool enable = true)
+        {
+            response_file = enable;
+            _Modified();
+            return *this;
+        }
+
+        // 添加子命令: 第一个不能识别为参数的 name 选择子命令, 之后的参数全部交给子命令的解析器
+        // 子命令的解析器在第一次被选中时才由 factory 构造, 之后复用; 全局参数只由当前解析器处理, 必须出现在子命令之前
+        Parser& AddCommand(const string_t& name, std::function<void (Parser&)> factory)
+        {
+            auto command = std::make_shared<_command_type>();
+            command->factory = std::move(factory);
+            commands[name] = command;
+            _Modified();
+            return *this;
+        }
+
+        // 子命令的解析器, 不存在时返回空指针
+        const Parser* GetCommand(std::string_view name) const
+        {
+            auto iter = commands.find(name);
+            return (iter != commands.end() ? &iter->second->get() : nullptr);
+        }
+
+        set_t<string_t> GetCommands() const
+        {
+            set_t<string_t> names;
+            for (auto& v : commands)
+                names.emplace(v.first);
+
+            return names;
+        }
+
+        // 统计解析结果和每个参数的出现、失败次数, timing 为 true 或者指定了 hook 时统计各阶段的耗时和延迟分布
+        // 未开启时只有一次空指针判断; 之后添加的参数同样计数, 复制的解析器(包括 FrozenParser)共享统计
+        Parser& EnableMetrics(bool enable = true, bool timing = false, latency_hook_t hook = nullptr)
+        {
+            metrics = (enable ? std::make_shared<_metrics_t>(option_id + 1, timing, std::move(hook)) : nullptr);
+            return *this;
+        }
+
+        metrics_t GetMetrics() const
+        {
+            metrics_t m;
+            if (metrics)
+            {
+                metrics->snapshot(m);
+                for (auto& opt : opt_map)
+                    m.options.push_back({ opt.second.first, metrics->hits(opt.first), metrics->failures(opt.first) });
+            }
+
+            return m;
+        }
+
+        void ResetMetrics()
+        {
+            if (metrics)
+                metrics->reset();
+        }
+
+        // 开启后 ParseCached 对相同的参数直接返回之前的结果, 最多缓存 capacity 个结果, capacity 为 0 时关闭
+        // 修改参数表(添加、删除参数, 约束, 子命令, 响应文件)时缓存清空; 命中时不经过解析, 不计入 GetMetrics
+        Parser& EnableCache(size_type capacity = 1024)
+        {
+            cache = (0 < capacity ? std::make_shared<_cache_t>(capacity) : nullptr);
+            return *this;
+        }
+
+        cache_stats_t GetCacheStats() const
+        {
+            return (cache ? cache->stats() : cache_stats_t());
+        }
+
+        using const_char_ptr = const string_t::value_type*;
+
+        // 解析结果的内部存储从 resource 中分配, 使用 arena 时结果不能在 arena 释放后继续使用, 复制的结果不受此限制
+        result_t Parse(const const_char_ptr* argv, size_type from, unsigned int to, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return _Parse(argv + from, argv + to, false, resource);
+        }
+
+        template<size_type n>
+        result_t Parse(const const_char_ptr(&argv)[n], unsigned int from) const
+        {
+            return Parse(argv, from, n);
+        }
+
+        template<size_type n>
+        result_t Parse(const const_char_ptr(&argv)[n]) const
+        {
+            return Parse(argv, 0, n);
+        }
+
+        result_t Parse(const list_t<string_t>& args, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return _Parse(args.begin(), args.end(), false, resource);
+        }
+
+        // 不复制输入参数, 结果中的字符串值借用输入参数的内存, 使用结果期间输入参数必须有效
+        result_t ParseView(const const_char_ptr* argv, size_type from, size_type to, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return _Parse(argv + from, argv + to, true, resource);
+        }
+
+        result_t ParseView(const std::string_view* args, size_type n, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return _Parse(args, args + n, true, resource);
+        }
+
+        // 按 POSIX shell 的规则切分一个命令行字符串后解析, 与 Parse 相同, 字符串值复制到结果中
+        // 不含引号和转义的参数直接使用 line 中的片段, 不复制
+        result_t ParseCommandLine(std::string_view line, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            _text_pool_t pool(resource);
+            pmr::list_t<std::string_view> args(resource);
+            args.reserve(line.size() / 8 + 1);
+
+            _tokenizer_t tokens(line);
+            for (std::string_view token; tokens.next(token); )
+                args.push_back(tokens.is_copied() ? pool.append(token) : token);
+
+            return _Parse(args.begin(), args.end(), false, resource);
+        }
+
+        // 与 Parse 相同, 但结果不可修改, 可以在多个线程中共享; 开启缓存时相同的参数返回同一个结果, 参见 EnableCache
+        // 开启响应文件时文件的内容可能变化, 不使用缓存
+        std::shared_ptr<const result_t> ParseCached(const list_t<string_t>& args) const
+        {
+            if (!cache || response_file)
+                return std::make_shared<const result_t>(Parse(args));
+
+            size_type h = _cache_t::hash(args.begin(), args.end());
+            if (auto result = cache->find(h, args.begin(), args.end()))
+                return result;
+
+            auto result = std::make_shared<const result_t>(Parse(args));
+            result->_prepare();
+            cache->insert(h, args.begin(), args.end(), result);
+            return result;
+        }
+
+        // 恢复 result_t::serialize 的结果, 字符串复制到结果中(使用默认的内存分配, 复制的结果共享), 只分配一次; 参数表必须与序列化时相同
+        // 数据无效或者参数表不同时抛出 std::invalid_argument
+        result_t Deserialize(std::string_view data, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return _Deserialize(data, false, resource);
+        }
+
+        // 与 Deserialize 相同, 但不复制字符串, 结果直接引用 data(如共享内存), 使用结果期间 data 必须有效
+        result_t DeserializeView(std::string_view data, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return _Deserialize(data, true, resource);
+        }
+
+        // 补全光标处的参数: args 为光标之前已经输入的参数, token 为光标处已经输入的部分, 最多返回 limit 个候选
+        // 前一个参数需要值或者 token 为 key=value 的形式时补全值, 只有值的模式匹配有限个字符串或者值为布尔类型时才有候选
+        // 否则按字典序返回以 token 开头的参数名和子命令, 不遍历全部参数; args 中出现子命令时由子命令的解析器补全
+        list_t<string_t> Complete(const list_t<string_t>& args, std::string_view token, size_type limit = result_t::npos) const
+        {
+            return _Complete(args.begin(), args.end(), token, limit);
+        }
+
+        // 按顺序合并多个来源(如默认值、配置文件、环境变量、命令行), 后面的来源优先
+        // 从优先级最高的来源开始解析, 已经由更高优先级来源指定的参数直接跳过, 不再校验和转换
+        // 唯一性和重复只在同一个来源中检查, 必需的参数在合并后检查
+        result_t ParseLayers(const list_t<list_t<string_t>>& layers, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            auto start = _StartTimer();
+            result_t result = _ParseLayers(layers, resource);
+            _Record(result, start);
+            return result;
+        }
+
+        // 与 previous 比较, 相同的前缀直接复用; 相同的后缀在状态一致时重放记录的参数检查和值, 不再匹配和转换; 只处理变化的参数
+        // 结果与 Parse 相同. previous 不是 Reparse 的结果、解析器被修改过、开启了响应文件或者使用了可以重复的参数时完整解析
+        // 定义了子命令时总是完整解析
+        result_t Reparse(const result_t& previous, const list_t<string_t>& args) const
+        {
+            if (!commands.empty())
+                return Parse(args);
+
+            auto start = _StartTimer();
+            result_t result = _Reparse(previous, args);
+            _Record(result, start);
+            return result;
+        }
+
+        // 将环境变量转换为参数, 变量名为 prefix 加上最长的参数名(去掉开头的'-', 大写, '-'替换为'_')
+        // 如 prefix 为 "APP_" 时 APP_THREADS=8 转换为 --threads=8, 没有值的参数在变量非空且不为 0 时加入
+        list_t<string_t> GetEnvironmentArgs(const string_t& prefix) const
+        {
+            list_t<string_t> args;
+            for (auto& opt : opt_map)
+            {
+                const string_t* key = nullptr;
+                for (auto& k : opt.second.first)
+                    if (!key || key->size() < k.size()) key = &k;
+
+                string_t name(prefix);
+                for (auto c : std::string_view(*key).substr(key->find_first_not_of('-') == string_t::npos ? key->size() : key->find_first_not_of('-')))
+                    name += ('-' == c ? '_' : static_cast<char>(std::toupper(static_cast<unsigned char>(c))));
+
+                const char* value = std::getenv(name.c_str());
+                if (nullptr == value)
+                    continue;
+
+                if (value_t::vt_nothing == opt.second.second.value_type())
+                {
+                    if ('\0' != value[0] && string_t("0") != value)
+                        args.push_back(*key);
+                }
+                else
+                {
+                    args.push_back(*key + "=" + value);
+                }
+            }
+
+            return args;
+        }
+
+        // 绑定到 _StructType 的参数写入 target, 其他参数保存在结果中, 出错时 target 可能已被部分修改
+        template<typename _StructType>
+        result_t ParseInto(const const_char_ptr* argv, size_type from, size_type to, _StructType& target) const
+        {
+            return _Parse(argv + from, argv + to, false, std::pmr::get_default_resource(), _target_type{ &target, &_type_tag<_StructType>::id });
+        }
+
+        template<typename _StructType>
+        result_t ParseInto(const list_t<string_t>& args, _StructType& target) const
+        {
+            return _Parse(args.begin(), args.end(), false, std::pmr::get_default_resource(), _target_type{ &target, &_type_tag<_StructType>::id });
+        }
+
+    private:
+
+        using id_type = _key_index_t::id_type;
+        using _option_type = pair_t<set_t<string_t>, option_t>;
+
+        // 子命令, 解析器在第一次使用时构造, 多个线程可以同时使用
+        struct _command_type
+        {
+            std::function<void (Parser&)> factory;
+            std::once_flag once;
+            std::shared_ptr<const Parser> parser;
+
+            const Parser& get()
+            {
+                std::call_once(once, [this]() {
+                    auto p = std::make_shared<Parser>();
+                    factory(*p);
+                    parser = p;
+                });
+
+                return *parser;
+            }
+        };
+
+        // 当前正在处理的参数
+        struct _matched_type
+        {
+            id_type id;
+            std::string_view key;
+            const _option_type* option;
+            bool skip{ false };     // 被优先级更高的来源覆盖, 只消耗参数不处理
+            _command_type* command{ nullptr };
+        };
+
+        using _parse_func_type = size_type(Parser::*)(result_t&, std::string_view, _matched_type&) const;
+
+        struct _target_type
+        {
+            void* object;
+            const void* type;
+        };
+
+        id_type option_id{ 0 };
+        map_t<string_t, id_type> key_map;
+        std::shared_ptr<_key_index_t> key_index{ std::make_shared<_key_index_t>() };
+        map_t<id_type, _option_type> opt_map;
+        bool response_file{ false };
+        std::map<string_t, std::shared_ptr<_command_type>, std::less<>> commands;
+        std::shared_ptr<_metrics_t> metrics;
+        std::shared_ptr<_cache_t> cache;
+
+        // 参数之间的约束, 位图按参数的 id 索引
+        struct _constraint_type
+        {
+            enum kind_t { c_exclusive, c_at_least_one, c_requires } kind;
+            id_type owner;                  // c_requires 中依赖其他参数的参数
+            list_t<std::uint64_t> mask;
+        };
+
+        list_t<std::uint64_t> required_mask;
+        list_t<_constraint_type> constraints;
+        std::uint64_t revision{ _NextRevision() };     // 参数表的版本号, 所有解析器中唯一, Reparse 只复用相同版本的记录
+
+        static std::uint64_t _NextRevision()
+        {
+            static std::atomic<std::uint64_t> next{ 0 };
+            return next.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+        enum { on_key, on_value, on_opt, parse_error, on_command };
+
+        void _update_option_id() { ++option_id; }
+
+        // 修改参数表(参数、约束、必需参数)后更新版本号并使用新的缓存, 复制的解析器(包括 FrozenParser)仍然使用原来的缓存
+        void _Modified()
+        {
+            revision = _NextRevision();
+            if (cache)
+                cache = std::make_shared<_cache_t>(cache->capacity(), cache.get());
+        }
+
+        _metrics_t::clock_type::time_point _StartTimer() const
+        {
+            return ((metrics && metrics->timing) ? _metrics_t::clock_type::now() : _metrics_t::clock_type::time_point());
+        }
+
+        void _Record(const result_t& result, _metrics_t::clock_type::time_point start) const
+        {
+            if (metrics)
+                metrics->finish(result.code(), start);
+        }
+
+        // 开启计时时统计 func 的耗时
+        template<typename _FuncType>
+        auto _Timed(_metrics_t::phase_t phase, _FuncType func) const
+        {
+            if (!metrics || !metrics->timing)
+                return func();
+
+            auto start = _metrics_t::clock_type::now();
+            auto r = func();
+            metrics->add(phase, start);
+            return r;
+        }
+
+        // 索引可能被解析结果共享, 修改前先复制
+        _key_index_t& _Index()
+        {
+            if (1 < key_index.use_count())
+                key_index = std::make_shared<_key_index_t>(*key_index);
+
+            return *key_index;
+        }
+
+        template<typename _IterType>
+        result_t _Parse(_IterType first, _IterType last, bool borrowed, std::pmr::memory_resource* resource, _target_type target = { nullptr, nullptr }) const
+        {
+            auto start = _StartTimer();
+            result_t result = (first == last ? result_t(state_t::s_nothing)
+                                             : _Parse(first, last, borrowed, resource, target, { &Parser::_OnKey, &Parser::_OnValue, &Parser::_OnOptional }));
+            _Record(result, start);
+            return result;
+        }
+
+        result_t _ParseLayers(const list_t<list_t<string_t>>& layers, std::pmr::memory_resource* resource) const
+        {
+            size_type n = 0;
+            for (auto& args : layers) n += args.size();
+
+            if (0 == n)
+                return result_t(state_t::s_nothing);
+
+            result_t result(key_index, n, false, resource);
+            for (size_type i = layers.size(); 0 < i && !result._is_unique; --i)
+            {
+                result._source = static_cast<unsigned int>(i - 1);
+                result._source_begin = result._values.size();
+                if (!_ParseArgs(result, layers[i - 1].begin(), layers[i - 1].end(), { &Parser::_OnKey, &Parser::_OnValue, &Parser::_OnOptional }))
+                    return result;
+            }
+
+            result._cursor = result_t::npos;
+            _CheckResult(result);
+
+            return result;
+        }
+
+        result_t _Reparse(const result_t& previous, const list_t<string_t>& args) const
+        {
+            if (args.empty())
+                return result_t(state_t::s_nothing);
+
+            result_t result(key_index, args.size(), false, std::pmr::get_default_resource());
+            result._trace = std::make_shared<result_t::_trace_t>();
+
+            result_t::_trace_t& trace = *result._trace;
+            trace.revision = revision;
+            size_type length = 0;
+            for (auto& arg : args) length += arg.size();
+
+            trace.text.reserve(length);
+            trace.ends.reserve(args.size());
+            trace.steps.reserve(args.size());
+            trace.actions.reserve(args.size() * 2);
+            for (auto& arg : args)
+            {
+                trace.text += arg;
+                trace.ends.push_back(trace.text.size());
+            }
+
+            const result_t::_trace_t* old = nullptr;
+            if (previous._trace && previous._trace->revision == revision && previous._index == key_index && previous._lists.empty() && !response_file)
+                old = previous._trace.get();
+
+            size_type m = (old ? old->size() : 0), n = args.size(), p = 0, q = 0;
+            if (old)
+            {
+                size_type e = 0;
+                while (e < old->steps.size() && parse_error != old->steps[e].state) ++e;
+                while (p < m && p < n && p < e && old->token(p) == args[p]) ++p;
+                while (q < m - p && q < n - p && old->token(m - 1 - q) == args[n - 1 - q]) ++q;
+            }
+
+            _matched_type k{ 0, std::string_view(), nullptr };
+            size_type index(on_key);
+
+            if (0 < p)
+            {
+                const auto& step = old->steps[p - 1];
+                for (size_type i = 0; i < step.values; ++i)
+                    result._insert(previous._values[i]);
+
+                trace.steps.assign(old->steps.begin(), old->steps.begin() + p);
+                trace.actions.assign(old->actions.begin(), old->actions.begin() + step.actions);
+                result._is_unique = step.unique;
+                index = step.state;
+                k = { step.id, step.key, (step.id ? &opt_map.at(step.id) : nullptr) };
+            }
+
+            const _parse_func_type functions[] = { &Parser::_OnKey, &Parser::_OnValue, &Parser::_OnOptional };
+            list_t<string_t> files;
+
+            for (size_type i = p; i < n && index < std::size(functions); ++i)
+            {
+                result._cursor = i;
+                if (n - q <= i && _IsSynced(*old, i + m - n, index, k))
+                    index = _Replay(result, previous, i + m - n, k);
+                else
+                    index = _Next(result, args[i], k, index, functions, files);
+
+                trace.steps.push_back({ index, k.id, k.key, trace.actions.size(), result._values.size(), result._is_unique });
+            }
+
+            switch (index)
+            {
+            case on_opt:
+                _AddValue(result, k);
+                [[fallthrough]];
+            case on_key:
+                result._cursor = result_t::npos;
+                // 出现的参数没有变化时, 必需参数的检查结果不变
+                if (!old || !old->checked || result._is_unique != previous._is_unique || result._present != previous._present)
+                    _CheckResult(result);
+                trace.checked = result.is_valid();
+                break;
+            case on_value:
+                result._cursor = n - 1;
+                result._set_error(state_t::s_v_missing, k.id, k.key);
+                break;
+            default:
+                break;
+            }
+
+            return result;
+        }
+
+        template<typename _IterType, size_type n>
+        result_t _Parse(_IterType first, _IterType last, bool borrowed, std::pmr::memory_resource* resource, _target_type target, const _parse_func_type(&_parse_functions)[n]) const
+        {
+            result_t result(key_index, static_cast<size_type>(std::distance(first, last)), borrowed, resource);
+            result._target = target.object;
+            result._target_type = target.type;
+
+            if (_ParseArgs(result, first, last, _parse_functions))
+            {
+                result._cursor = result_t::npos;
+                _CheckResult(result);
+            }
+
+            return result;
+        }
+
+        template<typename _IterType, size_type n>
+        bool _ParseArgs(result_t& result, _IterType first, _IterType last, const _parse_func_type(&_parse_functions)[n]) const
+        {
+            _matched_type k{ 0, std::string_view(), nullptr };
+            size_type index(on_key);
+            list_t<string_t> files;
+
+            result._cursor = 0;
+            for (; first != last && index < n; ++first, ++result._cursor)
+                index = _Next(result, std::string_view(*first), k, index, _parse_functions, files);
+
+            switch (index)
+            {
+            case on_opt:
+                _AddValue(result, k);
+                [[fallthrough]];
+            case on_key:
+                return true;
+            case on_value:
+                --result._cursor;
+                result._set_error(state_t::s_v_missing, k.id, k.key);
+                return false;
+            case on_command:
+                return _Dispatch(result, k, first, last, _parse_functions);
+            default:
+                return false;
+            }
+        }
+
+        // 剩余的参数由子命令的解析器解析, 结果保存在 result 中
+        template<typename _IterType, size_type n>
+        bool _Dispatch(result_t& result, const _matched_type& k, _IterType first, _IterType last, const _parse_func_type(&_parse_functions)[n]) const
+        {
+            const Parser& parser = k.command->get();
+            auto resource = result._values.get_allocator().resource();
+
+            result_t sub(parser.key_index, static_cast<size_type>(std::distance(first, last)), result._is_borrowed, resource);
+            sub._target = result._target;
+            sub._target_type = result._target_type;
+
+            if (parser._ParseArgs(sub, first, last, _parse_functions))
+            {
+                sub._cursor = result_t::npos;
+                parser._CheckResult(sub);
+            }
+
+            bool valid = sub.is_valid();
+            if (!valid)
+                result._adopt_error(sub, result._cursor);
+
+            result._command.assign(k.key.data(), k.key.size());
+            result._command_result = result_t::_share(std::move(sub), resource);
+            return valid;
+        }
+
+        result_t _Deserialize(std::string_view data, bool borrowed, std::pmr::memory_resource* resource) const
+        {
+            _binary_t::header_t h;
+            _binary_t::reader_t reader(data);
+            reader.get(h);
+            if (_binary_t::magic != h.magic || _binary_t::version != h.version)
+                _binary_t::fail("unknown format or version");
+
+            if (data.size() != h.size || static_cast<std::uint32_t>(state_t::s_f_error) < h.state || data.size() - sizeof(h) < std::uint64_t(h.text) + h.command)
+                _binary_t::fail("inconsistent header");
+
+            std::string_view text = data.substr(h.size - h.command - h.text, h.text);
+            std::string_view sub = data.substr(h.size - h.command);
+
+            // 没有任何参数时结果不引用参数表
+            bool indexed = (0 < h.bound);
+            if (indexed && key_index->bound() != h.bound)
+                _binary_t::fail("the parser has different options");
+
+            if (!indexed && (0 < h.slots || 0 < h.lists || 0 < h.command))
+                _binary_t::fail("inconsistent header");
+
+            reader.expect(h.slots, sizeof(_binary_t::slot_t));
+
+            result_t result = (indexed ? result_t(key_index, h.slots, borrowed, resource) : result_t(state_t::s_nothing));
+            result._state = static_cast<state_t>(h.state);
+            result._error_id = h.error_id;
+            result._error_index = static_cast<size_type>(h.error_index);
+            result._error_source = static_cast<size_type>(h.error_source);
+
+            if (!borrowed && !text.empty())
+            {
+                result._pool = result_t::_make_pool();
+                text = result._pool->append(text);
+            }
+
+            std::string_view a = _binary_t::text(text, h.hint[0], h.hint[1]), b = _binary_t::text(text, h.hint[2], h.hint[3]);
+            if (borrowed)
+            {
+                result._error[0] = a;
+                result._error[1] = b;
+                result._error_borrowed = true;
+            }
+            else
+            {
+                result._extra.first.assign(a.data(), a.size());
+                result._extra.second.assign(b.data(), b.size());
+            }
+
+            size_type present = reader.position();
+            reader.skip(result._present.size() * sizeof(std::uint64_t));
+
+            for (std::uint32_t i = 0; i < h.slots; ++i)
+            {
+                _binary_t::slot_t slot;
+                reader.get(slot);
+
+                // 参数名与 id 必须与当前的参数表一致, 按 id 找到参数后只比较它的参数名, 结果中的参数名引用恢复的字符串
+                std::string_view key = _binary_t::text(text, slot.key[0], slot.key[1]);
+                auto iter = opt_map.find(slot.id);
+                if (iter == opt_map.end() || result._test(slot.id) || h.lists < slot.list
+                    || std::none_of(iter->second.first.begin(), iter->second.first.end(), [key](const string_t& k) { return k == key; }))
+                    _binary_t::fail("the parser has different options");
+
+                const option_t& opt = iter->second.second;
+                value_t vt = static_cast<value_t>(slot.type);
+                if (value_t::vt_nothing != vt && (vt != opt.value_type() || 0 < slot.list))
+                    _binary_t::fail("mismatched value type");
+
+                result_t::_value_t value;
+                std::string_view v;
+                if (value_t::vt_string == vt || value_t::vt_custom == vt)
+                    v = _binary_t::text(text, slot.value & 0xFFFFFFFF, slot.value >> 32);
+
+                switch (vt)
+                {
+                case value_t::vt_boolean:  value = (0 != slot.value); break;
+                case value_t::vt_integer:  value = static_cast<int>(static_cast<std::int64_t>(slot.value)); break;
+                case value_t::vt_unsigned: value = static_cast<unsigned int>(slot.value); break;
+                case value_t::vt_float:    { double x; std::memcpy(&x, &slot.value, sizeof(x)); value = x; } break;
+                case value_t::vt_string:   value = v; break;
+                case value_t::vt_custom:
+                    {
+                        _custom_t x;
+                        if (!opt._convert || !opt._convert(v, x))
+                            _binary_t::fail("can't convert the custom value");
+                        value = std::move(x);
+                    }
+                    break;
+                default:
+                    break;
+                }
+
+                result._insert({ slot.id, key, std::move(value), slot.list, slot.source });
+            }
+
+            // 位图必须与值表一致
+            _binary_t::reader_t bits(data.substr(present));
+            for (auto w : result._present)
+            {
+                std::uint64_t x;
+                bits.get(x);
+                if (x != w)
+                    _binary_t::fail("inconsistent presence bitset");
+            }
+
+            auto alloc = result._values.get_allocator();
+            for (std::uint32_t i = 0; i < h.lists; ++i)
+            {
+                std::uint32_t type, n;
+                reader.get(type);
+                reader.get(n);
+
+                auto read = [&](auto list) {
+                    using _Type = typename decltype(list)::value_type;
+                    reader.expect(n, std::is_same_v<_Type, bool> ? 1 : (std::is_same_v<_Type, std::string_view> ? 8 : sizeof(_Type)));
+                    list.reserve(n);
+                    for (std::uint32_t j = 0; j < n; ++j)
+                    {
+                        if constexpr (std::is_same_v<_Type, std::string_view>)
+                        {
+                            std::uint32_t t[2];
+                            reader.get(t);
+                            list.push_back(_binary_t::text(text, t[0], t[1]));
+                        }
+                        else if constexpr (std::is_same_v<_Type, bool>)
+                        {
+                            std::uint8_t x;
+                            reader.get(x);
+                            list.push_back(0 != x);
+                        }
+                        else
+                        {
+                            _Type x;
+                            reader.get(x);
+                            list.push_back(x);
+                        }
+                    }
+                    result._lists.emplace_back(std::move(list));
+                };
+
+                switch (type)
+                {
+                case 0: read(pmr::list_t<bool>(alloc)); break;
+                case 1: read(pmr::list_t<int>(alloc)); break;
+                case 2: read(pmr::list_t<unsigned int>(alloc)); break;
+                case 3: read(pmr::list_t<double>(alloc)); break;
+                case 4: read(pmr::list_t<std::string_view>(alloc)); break;
+                default: _binary_t::fail("unknown list type");
+                }
+            }
+
+            for (auto& slot : result._values)
+            {
+                if (slot.list && result._lists[slot.list - 1].index() != _ListIndex(opt_map.at(slot.id).second.value_type()))
+                    _binary_t::fail("mismatched value type");
+            }
+
+            if (0 < h.command)
+            {
+                std::string_view name = _binary_t::text(text, h.name[0], h.name[1]);
+                auto iter = commands.find(name);
+                if (iter == commands.end())
+                    _binary_t::fail("the parser has different commands");
+
+                result._command.assign(name.data(), name.size());
+                result._command_result = result_t::_share(iter->second->get()._Deserialize(sub, borrowed, resource), resource);
+            }
+
+            return result;
+        }
+
+        // 可以重复的参数的值类型在 result_t::_list_t 中的下标, 与 result_t::_open_list 一致
+        static size_type _ListIndex(value_t vt)
+        {
+            switch (vt)
+            {
+            case value_t::vt_boolean:  return 0;
+            case value_t::vt_integer:  return 1;
+            case value_t::vt_unsigned: return 2;
+            case value_t::vt_float:    return 3;
+            default:                   return 4;
+            }
+        }
+
+        template<typename _IterType>
+        list_t<string_t> _Complete(_IterType first, _IterType last, std::string_view token, size_type limit) const
+        {
+            // 与解析相同: 唯一的参数之后总是值, 不唯一的参数之后的值可以省略
+            const option_t* pending = nullptr;
+            for (; first != last; ++first)
+            {
+                std::string_view arg(*first);
+                bool consumed = (pending && (pending->is_value_required() || pending->is_unique()));
+                pending = nullptr;
+                if (consumed)
+                    continue;
+
+                auto match = key_index->match(arg);
+                if (0 < match.first && _is_perfect_match(arg, match.second))
+                {
+                    auto& opt = opt_map.at(match.first).second;
+                    if (value_t::vt_nothing != opt.value_type())
+                        pending = &opt;
+                    continue;
+                }
+
+                auto iter = commands.find(arg);
+                if (iter != commands.end())
+                    return iter->second->get()._Complete(std::next(first), last, token, limit);
+            }
+
+            list_t<string_t> candidates;
+            if (pending)
+            {
+                _CompleteValue(*pending, std::string_view(), token, limit, candidates);
+                if (pending->is_value_required() || pending->is_unique())
+                    return candidates;
+            }
+
+            auto match = key_index->match(token);
+            if (0 < match.first && match.second.size() < token.size() && '=' == token[match.second.size()])
+            {
+                size_type n = match.second.size() + 1;
+                _CompleteValue(opt_map.at(match.first).second, token.substr(0, n), token.substr(n), limit, candidates);
+                return candidates;
+            }
+
+            key_index->visit(token, [&](id_type, std::string_view key) {
+                if (limit <= candidates.size()) return false;
+                candidates.emplace_back(key);
+                return true;
+            });
+
+            for (auto iter = commands.lower_bound(token); iter != commands.end() && candidates.size() < limit; ++iter)
+            {
+                if (0 != iter->first.compare(0, token.size(), token))
+                    break;
+                candidates.push_back(iter->first);
+            }
+
+            return candidates;
+        }
+
+        // 候选值为 key 加上以 prefix 开头的值, 值的模式匹配的字符串过多时只列出前 _max_values 个
+        static void _CompleteValue(const option_t& opt, std::string_view key, std::string_view prefix, size_type limit, list_t<string_t>& candidates)
+        {
+            constexpr size_type _max_values = 1024;
+            if (limit <= candidates.size())
+                return;
+
+            list_t<string_t> values;
+            if (opt._pattern)
+            {
+                if (!opt._pattern->enumerate(prefix, values, std::min(limit - candidates.size(), _max_values)))
+                    return;
+            }
+            else if (!opt._check && value_t::vt_boolean == opt.value_type())
+            {
+                for (std::string_view v : { "false", "true" })
+                {
+                    if (0 == v.compare(0, prefix.size(), prefix))
+                        values.emplace_back(v);
+                }
+            }
+
+            for (auto& v : values)
+            {
+                if (limit <= candidates.size()) break;
+                candidates.push_back(string_t(key) + v);
+            }
+        }
+
+        // 子命令只能在当前解析器中还没有选中子命令时出现
+        bool _IsCommand(const result_t& result, std::string_view arg, _matched_type& k) const
+        {
+            if (commands.empty() || !result._command.empty())
+                return false;
+
+            auto iter = commands.find(arg);
+            if (iter == commands.end())
+                return false;
+
+            k = { 0, iter->first, nullptr };
+            k.command = iter->second.get();
+            return true;
+        }
+
+        template<size_type n>
+        size_type _Next(result_t& result, std::string_view arg, _matched_type& k, size_type index, const _parse_func_type(&_parse_functions)[n], list_t<string_t>& files) const
+        {
+            if (response_file && 1 < arg.size() && '@' == arg[0])
+                return _Expand(result, arg.substr(1), k, index, _parse_functions, files);
+
+            return (this->*_parse_functions[index])(result, arg, k);
+        }
+
+        // 文件中的参数直接送入状态机, 其中的字符串值总是复制到结果中
+        template<size_type n>
+        size_type _Expand(result_t& result, std::string_view path, _matched_type& k, size_type index, const _parse_func_type(&_parse_functions)[n], list_t<string_t>& files) const
+        {
+            _mapped_file_t file{ string_t(path) };
+            if (!file.is_open())
+            {
+                result._set_error(state_t::s_f_error, 0, path, "no such file");
+                return parse_error;
+            }
+
+            if (std::find(files.begin(), files.end(), file.id()) != files.end())
+            {
+                result._set_error(state_t::s_f_error, 0, path, "recursive inclusion");
+                return parse_error;
+            }
+
+            files.push_back(file.id());
+            bool borrowed = result._is_borrowed;
+            result._is_borrowed = false;
+
+            _tokenizer_t tokens(file.data());
+            for (std::string_view token; index < n && tokens.next(token); )
+                index = _Next(result, token, k, index, _parse_functions, files);
+
+            result._is_borrowed = borrowed;
+            files.pop_back();
+
+            // 子命令必须直接出现在参数中
+            if (on_command == index)
+            {
+                result._set_error(state_t::s_k_unrecognized, 0, k.key);
+                return parse_error;
+            }
+
+            return index;
+        }
+
+        size_type _OnKey(result_t& result, std::string_view arg, _matched_type& k) const
+        {
+            auto match = _Timed(_metrics_t::p_match, [&]() { return key_index->match(arg); });
+            if (0 < match.first)
+            {
+                _matched_type m{ match.first, match.second, &opt_map.at(match.first) };
+
+                if (_is_perfect_match(arg, m.key))
+                    return _OnPerfectMatch(result, m, k);
+
+                if (_is_equation(arg, m.key))
+                    return _OnEquation(result, m, arg.substr(m.key.size() + 1));
+            }
+
+            if (_IsCommand(result, arg, k))
+                return on_command;
+
+            result._set_error(state_t::s_k_unrecognized, 0, arg);
+            return parse_error;
+        }
+
+        size_type _OnValue(result_t& result, std::string_view arg, _matched_type& k) const
+        {
+            return _OnValueEx(result, k, arg);
+        }
+
+        size_type _OnOptional(result_t& result, std::string_view arg, _matched_type& k) const
+        {
+            if (k.option->second.is_unique())
+                return _OnValueEx(result, k, arg);
+
+            auto match = _Timed(_metrics_t::p_match, [&]() { return key_index->match(arg); });
+            if (0 < match.first)
+            {
+                _matched_type m{ match.first, match.second, &opt_map.at(match.first) };
+
+                if (_is_perfect_match(arg, m.key))
+                {
+                    _AddValue(result, k);
+                    return _OnPerfectMatch(result, m, k);
+                }
+
+                if (_is_equation(arg, m.key))
+                {
+                    _AddValue(result, k);
+                    return _OnEquation(result, m, arg.substr(m.key.size() + 1));
+                }
+            }
+
+            // 可选的值与子命令同名时优先作为子命令
+            if (!commands.empty())
+            {
+                _matched_type c{ k };
+                if (_IsCommand(result, arg, c))
+                {
+                    _AddValue(result, k);
+                    k = c;
+                    return on_command;
+                }
+            }
+
+            return _OnValue(result, arg, k);
+        }
+
+        size_type _OnPerfectMatch(result_t& result, const _matched_type& m, _matched_type& k) const
+        {
+            if (metrics) metrics->hit(m.id);
+
+            const option_t& opt = m.option->second;
+            bool skip = result._is_overridden(m.id, opt);
+            if (!skip && !result._check_key(m.id, m.key, opt))
+                return parse_error;
+
+            k = m;
+            k.skip = skip;
+            if (skip)
+                return (value_t::vt_nothing == opt.value_type() ? on_key : (opt.is_value_required() ? on_value : on_opt));
+
+            if (value_t::vt_nothing == opt.value_type())
+            {
+                result._add_value(m.id, m.key, opt);
+                return on_key;
+            }
+
+            return (opt.is_value_required() ? on_value : on_opt);
+        }
+
+        size_type _OnEquation(result_t& result, const _matched_type& m, std::string_view value) const
+        {
+            if (metrics) metrics->hit(m.id);
+
+            if (result._is_overridden(m.id, m.option->second))
+                return on_key;
+
+            if (!result._check_key(m.id, m.key, m.option->second))
+                return parse_error;
+
+            if (value_t::vt_nothing == m.option->second.value_type())
+            {
+                result._set_error(state_t::s_v_redundant, m.id, m.key);
+                return parse_error;
+            }
+
+            return _OnValueEx(result, m, value);
+        }
+
+        size_type _OnValueEx(result_t& result, const _matched_type& m, std::string_view value) const
+        {
+            if (m.skip)
+                return on_key;
+
+            const option_t& opt = m.option->second;
+            // 可以重复的参数在拆分后逐个校验
+            bool split = (opt.is_multiple() && !result._is_bound(opt));
+            if ((split || opt._is_builtin() || _Timed(_metrics_t::p_check, [&]() { return opt._check_value(value); }))
+                && _Timed(_metrics_t::p_convert, [&]() { return result._add_value(m.id, m.key, value, opt); }))
+                return on_key;
+
+            if (metrics) metrics->fail(m.id);
+            result._set_error(state_t::s_v_error, m.id, m.key, value);
+            return parse_error;
+        }
+
+        // 处理第 j 个参数前的状态与上一次解析相同, 并且上一次没有在这个参数上出错
+        static bool _IsSynced(const result_t::_trace_t& old, size_type j, size_type index, const _matched_type& k)
+        {
+            if (old.steps.size() <= j || parse_error == old.steps[j].state)
+                return false;
+
+            if (0 == j)
+                return (on_key == index && 0 == k.id);
+
+            const auto& step = old.steps[j - 1];
+            return (step.state == index && step.id == k.id && step.key == k.key);
+        }
+
+        // 重新检查上一次记录的参数, 直接复制转换好的值
+        size_type _Replay(result_t& result, const result_t& previous, size_type j, _matched_type& k) const
+        {
+            const result_t::_trace_t& old = *previous._trace;
+            const auto& step = old.steps[j];
+
+            for (size_type i = (j ? old.steps[j - 1].actions : 0); i < step.actions; ++i)
+            {
+                const auto& action = old.actions[i];
+                if (result_t::npos == action.slot)
+                {
+                    if (metrics) metrics->hit(action.id);
+                    if (!result._check_key(action.id, action.key, opt_map.at(action.id).second))
+                        return parse_error;
+                }
+                else
+                {
+                    result._add_value(action.id, action.key, result_t::_value_t(previous._values[action.slot].value));
+                }
+            }
+
+            k = { step.id, step.key, (step.id ? &opt_map.at(step.id) : nullptr) };
+            return step.state;
+        }
+
+        void _AddValue(result_t& result, const _matched_type& k) const
+        {
+            if (!k.skip)
+                result._add_value(k.id, k.key, k.option->second);
+        }
+
+        bool _RemoveOption(id_type id, const string_t& key)
+        {
+            auto iter = opt_map.find(id);
+            if (iter != opt_map.end())
+            {
+                iter->second.first.erase(key);
+                if (iter->second.first.empty())
+                {
+                    opt_map.erase(iter);
+                    _ClearConstraints(id);
+                }
+
+                return true;
+            }
+
+            return false;
+        }
+
+        static void _SetBit(list_t<std::uint64_t>& mask, id_type id)
+        {
+            if (mask.size() <= id / 64)
+                mask.resize(id / 64 + 1, 0);
+
+            mask[id / 64] |= (std::uint64_t(1) << (id % 64));
+        }
+
+        static void _ClearBit(list_t<std::uint64_t>& mask, id_type id)
+        {
+            if (id / 64 < mask.size())
+                mask[id / 64] &= ~(std::uint64_t(1) << (id % 64));
+        }
+
+        // mask 中从 from 开始第一个出现(present 为 true)或者没有出现的参数, 没有时为 0
+        static id_type _FindBit(const list_t<std::uint64_t>& mask, const result_t& result, bool present, id_type from = 0)
+        {
+            for (size_type w = from / 64; w < mask.size(); ++w)
+            {
+                std::uint64_t p = (w < result._present.size() ? result._present[w] : 0);
+                std::uint64_t x = mask[w] & (present ? p : ~p);
+                if (w == from / 64)
+                    x &= (~std::uint64_t(0) << (from % 64));
+
+                if (x)
+                    return static_cast<id_type>(w * 64 + _lowest_bit(x));
+            }
+
+            return 0;
+        }
+
+        Parser& _AddConstraint(_constraint_type::kind_t kind, id_type owner, const set_t<string_t>& keys)
+        {
+            _constraint_type c{ kind, owner, {} };
+            for (auto& key : keys)
+            {
+                auto iter = key_map.find(key);
+                if (iter != key_map.end())
+                    _SetBit(c.mask, iter->second);
+            }
+
+            constraints.push_back(std::move(c));
+            _Modified();
+            return *this;
+        }
+
+        void _ClearConstraints(id_type id)
+        {
+            _Modified();
+            _ClearBit(required_mask, id);
+            for (auto& c : constraints)
+                _ClearBit(c.mask, id);
+
+            constraints.erase(std::remove_if(constraints.begin(), constraints.end(), [id](const _constraint_type& c) {
+                return (_constraint_type::c_requires == c.kind && c.owner == id);
+            }), constraints.end());
+        }
+
+        // 缺少的参数使用其第一个参数名, 出现的参数使用实际使用的参数名
+        // 取结果持有的索引中保存的参数名, 借用模式下解析器销毁或修改后仍然有效
+        std::string_view _FirstKey(const result_t& result, id_type id) const { return result._index->find_key(*opt_map.at(id).first.cbegin()); }
+
+        bool _CheckResult(result_t& result) const
+        {
+            if (state_t::s_ok != result.code())
+                return false;
+
+            if (result._is_unique)
+                return true;
+
+            if (id_type id = _FindBit(required_mask, result, false))
+            {
+                result._set_error(state_t::s_k_missing, id, _FirstKey(result, id));
+                return false;
+            }
+
+            for (auto& c : constraints)
+            {
+                switch (c.kind)
+                {
+                case _constraint_type::c_exclusive:
+                    if (id_type a = _FindBit(c.mask, result, true))
+                    {
+                        if (id_type b = _FindBit(c.mask, result, true, a + 1))
+                        {
+                            result._set_error(state_t::s_k_conflict, b, result._slot(b).key, result._slot(a).key);
+                            return false;
+                        }
+                    }
+                    break;
+                case _constraint_type::c_at_least_one:
+                    if (!_FindBit(c.mask, result, true))
+                    {
+                        if (id_type id = _FindBit(c.mask, result, false))
+                        {
+                            result._set_error(state_t::s_k_missing, id, _FirstKey(result, id));
+                            return false;
+                        }
+                    }
+                    break;
+                case _constraint_type::c_requires:
+                    if (result._test(c.owner))
+                    {
+                        if (id_type id = _FindBit(c.mask, result, false))
+                        {
+                            result._set_error(state_t::s_k_missing, id, _FirstKey(result, id), result._slot(c.owner).key);
+                            return false;
+                        }
+                    }
+                    break;
+                }
+            }
+
+            return true;
+        }
+
+        static bool _is_perfect_match(std::string_view text, std::string_view key)
+        {
+            return (text.size() == key.size());
+        }
+
+        static bool _is_equation(std::string_view text, std::string_view key)
+        {
+            return ((key.size() + 1) < text.size() && '=' == text[key.size()]);
+        }
+
+    };  // class Parser
+
+    // 不可修改的解析器, 可以在多个线程中同时调用 Parse 和 ParseBatch
+    class FrozenParser
+    {
+        friend class SharedParser;
+
+        const Parser _parser;
+
+    public:
+
+        explicit FrozenParser(const Parser& parser) : _parser(parser) { }
+        explicit FrozenParser(Parser&& parser) : _parser(std::move(parser)) { }
+
+        metrics_t GetMetrics() const { return _parser.GetMetrics(); }
+
+        using const_char_ptr = Parser::const_char_ptr;
+
+        result_t Parse(const const_char_ptr* argv, size_type from, size_type to, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return _parser._Parse(argv + from, argv + to, false, resource);
+        }
+
+        result_t Parse(const list_t<string_t>& args, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return _parser.Parse(args, resource);
+        }
+
+        result_t ParseView(const std::string_view* args, size_type n, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return _parser.ParseView(args, n, resource);
+        }
+
+        result_t ParseCommandLine(std::string_view line, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return _parser.ParseCommandLine(line, resource);
+        }
+
+        list_t<string_t> Complete(const list_t<string_t>& args, std::string_view token, size_type limit = result_t::npos) const
+        {
+            return _parser.Complete(args, token, limit);
+        }
+
+        result_t Deserialize(std::string_view data, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return _parser.Deserialize(data, resource);
+        }
+
+        std::shared_ptr<const result_t> ParseCached(const list_t<string_t>& args) const
+        {
+            return _parser.ParseCached(args);
+        }
+
+        cache_stats_t GetCacheStats() const
+        {
+            return _parser.GetCacheStats();
+        }
+
+        result_t DeserializeView(std::string_view data, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return _parser.DeserializeView(data, resource);
+        }
+
+        template<typename _StructType>
+        result_t ParseInto(const const_char_ptr* argv, size_type from, size_type to, _StructType& target) const
+        {
+            return _parser.ParseInto(argv, from, to, target);
+        }
+
+        template<typename _StructType>
+        result_t ParseInto(const list_t<string_t>& args, _StructType& target) const
+        {
+            return _parser.ParseInto(args, target);
+        }
+
+        result_t Reparse(const result_t& previous, const list_t<string_t>& args) const
+        {
+            return _parser.Reparse(previous, args);
+        }
+
+        // 使用多个线程解析一批命令行, 结果与输入的顺序一致
+        // batch 中的每个元素是一组参数(如 list_t<string_t>), threads 为 0 时使用硬件线程数; 无法创建线程时使用较少的线程
+        template<typename _BatchType>
+        list_t<result_t> ParseBatch(const _BatchType& batch, size_type threads = 0) const
+        {
+            const size_type n = static_cast<size_type>(std::distance(std::begin(batch), std::end(batch)));
+            list_t<result_t> results(n);
+
+            if (0 == threads)
+                threads = std::max<size_type>(1, std::thread::hardware_concurrency());
+
+            const size_type grain = std::max<size_type>(1, std::min<size_type>(64, n / (threads * 8)));
+            threads = std::min(threads, (n + grain - 1) / grain);
+
+            // 每段的起始位置只遍历一次, 不要求随机访问
+            list_t<decltype(std::begin(batch))> starts;
+            starts.reserve((n + grain - 1) / grain);
+            auto first = std::begin(batch);
+            for (size_type i = 0; i < n; i += grain)
+            {
+                starts.push_back(first);
+                if (i + grain < n)
+                    std::advance(first, grain);
+            }
+
+            std::atomic<size_type> next{ 0 };
+            std::exception_ptr error;
+            std::atomic_flag failed = ATOMIC_FLAG_INIT;
+
+            auto work = [&]() {
+                try {
+                    for (size_type i = next.fetch_add(grain); i < n; i = next.fetch_add(grain))
+                    {
+                        auto iter = starts[i / grain];
+                        for (size_type end = std::min(n, i + grain); i < end; ++i, ++iter)
+                            results[i] = _parser._Parse(std::begin(*iter), std::end(*iter), false, std::pmr::get_default_resource());
+                    }
+                } catch (...) {
+                    if (!failed.test_and_set())
+                        error = std::current_exception();
+                    next = n;
+                }
+            };
+
+            // 无法创建更多线程时使用已经创建的线程完成解析
+            list_t<std::thread> workers;
+            workers.reserve(threads);
+            for (size_type i = 1; i < threads; ++i)
+            {
+                try {
+                    workers.emplace_back(work);
+                } catch (...) {
+                    break;
+                }
+            }
+
+            work();
+
+            for (auto& t : workers)
+                t.join();
+
+            if (error)
+                std::rethrow_exception(error);
+
+            return results;
+        }
+
+    };  // class FrozenParser
+
+    inline FrozenParser Parser::Freeze() const { return FrozenParser(*this); }
+
+    // 可以在解析的同时修改参数表的解析器
+    // 每次修改在当前版本的副本上进行, 完成后原子地发布为新的版本; 解析使用调用时的版本, 不加锁, 不受之后的修改影响
+    // 旧版本在最后一个使用者(包括 Snapshot 的返回值)释放后回收, 解析结果不依赖解析器, 可以继续使用
+    // 修改之间互斥, 每次修改复制一次参数表, 多个修改可以放在一次 Update 中
+    class SharedParser
+    {
+        std::shared_ptr<const FrozenParser> _current;
+        std::mutex _mutex;
+
+    public:
+
+        using const_char_ptr = Parser::const_char_ptr;
+        using snapshot_type = std::shared_ptr<const FrozenParser>;
+
+        explicit SharedParser(const Parser& parser = Parser()) : _current(std::make_shared<const FrozenParser>(parser)) { }
+
+        SharedParser(const SharedParser&) = delete;
+        SharedParser& operator=(const SharedParser&) = delete;
+
+        // 当前版本, 持有期间版本不变
+        snapshot_type Snapshot() const { return std::atomic_load(&_current); }
+
+        // func 的参数为当前版本的副本, 返回后发布
+        template<typename _FuncType>
+        SharedParser& Update(_FuncType func)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            Parser next(std::atomic_load(&_current)->_parser);
+            func(next);
+            std::atomic_store(&_current, snapshot_type(std::make_shared<const FrozenParser>(std::move(next))));
+
+            return *this;
+        }
+
+        SharedParser& AddOption(const pair_t<set_t<string_t>, option_t>& option)
+        {
+            return Update([&](Parser& parser) { parser.AddOption(option); });
+        }
+
+        size_type RemoveOption(const set_t<string_t>& keys)
+        {
+            size_type n = 0;
+            Update([&](Parser& parser) { n = parser.RemoveOption(keys); });
+            return n;
+        }
+
+        result_t Parse(const const_char_ptr* argv, size_type from, size_type to, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return Snapshot()->Parse(argv, from, to, resource);
+        }
+
+        result_t Parse(const list_t<string_t>& args, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return Snapshot()->Parse(args, resource);
+        }
+
+        result_t ParseView(const std::string_view* args, size_type n, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return Snapshot()->ParseView(args, n, resource);
+        }
+
+        result_t ParseCommandLine(std::string_view line, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return Snapshot()->ParseCommandLine(line, resource);
+        }
+
+        list_t<string_t> Complete(const list_t<string_t>& args, std::string_view token, size_type limit = result_t::npos) const
+        {
+            return Snapshot()->Complete(args, token, limit);
+        }
+
+        result_t Deserialize(std::string_view data, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return Snapshot()->Deserialize(data, resource);
+        }
+
+        result_t DeserializeView(std::string_view data, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+        {
+            return Snapshot()->DeserializeView(data, resource);
+        }
+
+        // 每次修改后的版本使用新的缓存
+        std::shared_ptr<const result_t> ParseCached(const list_t<string_t>& args) const
+        {
+            return Snapshot()->ParseCached(args);
+        }
+
+        template<typename _StructType>
+        result_t ParseInto(const list_t<string_t>& args, _StructType& target) const
+        {
+            return Snapshot()->ParseInto(args, target);
+        }
+
+    };  // class SharedParser
+
+    // 编译期参数表: 每个参数由一个类型描述, 参数名和值类型在编译期确定, 例如
+    // struct input : xf::cmd::static_option_t<std::string, false, true, true> { static constexpr const char* keys[]{ "-i", "--input" }; };
+    // 可以额外提供 static bool check(std::string_view) 对参数值做进一步校验
+    template<typename _ValueType, bool u, bool k, bool v>
+    struct static_option_t
+    {
+        using value_type = _ValueType;
+
+        static constexpr bool is_unique = u;
+        static constexpr bool is_key_required = k;
+        static constexpr bool is_value_required = v;
+    };  // struct static_option_t
+
+    template<typename _OptionType, typename = void>
+    struct _has_check : std::false_type { };
 
-        static string_t _make_info(state_t s, const string_t& a, const string_t& b)
-        {
-            switch (s)
-            {
-            case state_t::s_ok:
-                return "ok";
-            case state_t::s_nothing:
-                return R"(error: don't get any parameter.)";
-            case state_t::s_k_unrecognized:
-                return R"(error: unrecognized parameter ")" + a + R"(".)";
-            case state_t::s_k_duplicated:
-                return R"(error: repeat paramter ")" + a + R"(" and ")" + b + R"(".)";
-            case state_t::s_k_missing:
-                return R"(error: the parameter ")" + a + R"(" must be specified but not found.)";
-            case state_t::s_v_missing:
-                return R"(error: parameter ")" + a + R"(" must specify a value.)";
-            case state_t::s_v_redundant:
-                return R"(error: the parameter ")" + a + R"(" doesn't require value.)";
-            case state_t::s_v_error:
-                return R"(error: the ")" + b + R"(" can't be treated as the value of parameter ")" + a + R"(".)";
-            case state_t::s_k_conflict:
-                return R"(error: parameter ")" + a + R"(" can't be specified with other parameters.)";
-            default:
-                return string_t();
-            }
-        }
+    template<typename _OptionType>
+    struct _has_check<_OptionType, std::void_t<decltype(_OptionType::check(std::string_view()))>> : std::true_type { };
 
-        void _set_error(state_t s, const string_t& a = string_t(), const string_t& b = string_t())
-        {
-            _state = s;
-            _extra.first = a;
-            _extra.second = b;
+    // StaticParser 的参数名表: 编译期按长度从长到短分组, 同一长度内按字典序排列
+    // 同名的参数名保持参数的先后顺序, 查找时取第一个
+    struct _static_key_t
+    {
+        std::string_view key;
+        size_type index = 0;
+    };
 
-            _info = _make_info(_state, _extra.first, _extra.second);
-        }
+    struct _static_group_t
+    {
+        size_type length = 0;
+        size_type first = 0;
+        size_type last = 0;
+    };
 
-        bool _check_key(const string_t& key, const option_t& opt)
-        {
-            if (_k_map.empty())
-            {
-                if (opt.is_unique()) _is_unique = true;
-                return true;
-            }
+    template<typename _OptionType, size_type _Count>
+    constexpr void _fill_static_keys(std::array<_static_key_t, _Count>& table, size_type& n, size_type index)
+    {
+        for (std::string_view key : _OptionType::keys)
+            table[n++] = { key, index };
+    }
 
-            if (_is_unique)
-            {
-                _set_error(state_t::s_k_conflict, _v_map.begin()->first);
-                return false;
-            }
+    template<size_type _Count, typename... _Options, size_type... i>
+    constexpr std::array<_static_key_t, _Count> _make_static_keys(std::index_sequence<i...>)
+    {
+        std::array<_static_key_t, _Count> table{};
+        size_type n = 0;
+        (_fill_static_keys<_Options>(table, n, i), ...);
 
-            if (opt.is_unique())
+        // 插入排序, 相等的参数名不交换
+        for (size_type a = 1; a < _Count; ++a)
+        {
+            _static_key_t k = table[a];
+            size_type b = a;
+            for (; 0 < b; --b)
             {
-                _set_error(state_t::s_k_conflict, key);
-                return false;
-            }
+                const _static_key_t& prev = table[b - 1];
+                if (prev.key.size() > k.key.size() || (prev.key.size() == k.key.size() && !(k.key < prev.key)))
+                    break;
 
-            auto iter = _k_map.find(key);
-            if (iter != _k_map.end())
-            {
-                _set_error(state_t::s_k_duplicated, iter->second, key);
-                return false;
+                table[b] = prev;
             }
 
-            return true;
+            table[b] = k;
         }
 
-        template<typename _Type>
-        void _add_value(const string_t& key, const _Type& value, const set_t<string_t>& keys)
-        {
-            _v_map.emplace(key, variant_t(value));
-            for (auto k : keys) _k_map.emplace(k, key);
-        }
+        return table;
+    }
 
-        void _add_value(const string_t& key, const string_t& value, const set_t<string_t>& keys, const option_t& opt)
+    template<size_type _Count>
+    constexpr size_type _count_static_groups(const std::array<_static_key_t, _Count>& table)
+    {
+        size_type n = 0;
+        for (size_type a = 0; a < _Count; ++a)
         {
-            switch (opt.value_type())
-            {
-            case value_t::vt_string:
-                _add_value(key, value, keys);
-                break;
-            case value_t::vt_boolean:
-                _add_value(key, ('t' == value[0] || 'T' == value[0]), keys);
-                break;
-            case value_t::vt_float:
-                _add_value(key, std::stod(value), keys);
-                break;
-            case value_t::vt_integer:
-                _add_value(key, std::stoi(value), keys);
-                break;
-            case value_t::vt_unsigned:
-                _add_value(key, (unsigned int)(std::stoul(value)), keys);
-                break;
-            case value_t::vt_nothing:
-                _add_value(key, nullptr, keys);
-                break;
-            default:
-                break;
-            }
+            if (0 == a || table[a].key.size() != table[a - 1].key.size())
+                ++n;
         }
 
-        void _add_value(const string_t& key, const set_t<string_t>& keys)
+        return n;
+    }
+
+    template<size_type _Groups, size_type _Count>
+    constexpr std::array<_static_group_t, _Groups> _make_static_groups(const std::array<_static_key_t, _Count>& table)
+    {
+        std::array<_static_group_t, _Groups> groups{};
+        size_type n = 0;
+        for (size_type a = 0; a < _Count; ++a)
         {
-            _add_value(key, nullptr, keys);
+            if (0 == a || table[a].key.size() != table[a - 1].key.size())
+                groups[n++] = { table[a].key.size(), a, a };
+
+            groups[n - 1].last = a + 1;
         }
 
-    };  // class result_t
+        return groups;
+    }
 
-    class Parser
+    template<typename... _Options> class StaticParser;
+
+    template<typename... _Options>
+    class static_result_t
     {
-    public:
+        template<typename...> friend class StaticParser;
 
-        Parser() = default;
+        static constexpr size_type _size = sizeof...(_Options);
 
-        Parser(const list_t<pair_t<set_t<string_t>, option_t>>& options)
+        template<typename _OptionType>
+        static constexpr size_type _index_of()
         {
-            for (auto opt : options) AddOption(opt);
+            size_type i = 0, n = _size;
+            ((std::is_same_v<_OptionType, _Options> ? (n = i, ++i) : ++i), ...);
+            return n;
         }
 
-        Parser& AddOption(const pair_t<set_t<string_t>, option_t>& option)
-        {
-            if (!option.first.empty())
-            {
-                _update_option_id();
+        template<typename _OptionType>
+        static constexpr size_type _index = _index_of<_OptionType>();
 
-                opt_map.emplace(option_id, option);
+        state_t _state{ state_t::s_ok };
+        string_t _info{ "ok" };
+        pair_t<string_t, string_t> _extra;
+        std::tuple<typename _Options::value_type...> _values;
+        std::array<std::string_view, _size> _keys;      // 命令行中使用的参数名
+        std::bitset<_size> _existing;
+        std::bitset<_size> _valued;
+        std::string_view _first;
+        bool _is_unique{ false };
 
-                for (auto key : option.first)
-                {
-                    auto iter = key_map.find(key);
-                    if (iter != key_map.end())
-                    {
-                        _RemoveOption(iter->second, key);
-                        iter->second = option_id;
-                    }
-                    else
-                    {
-                        key_map.emplace(key, option_id);
-                    }
-                }
-            }
+    public:
 
-            return *this;
-        }
+        state_t code() const { return _state; }
+        const string_t& info() const { return _info; }
+        const pair_t<string_t, string_t>& hint() const { return _extra; }
+        bool is_valid() const { return (state_t::s_ok == code()); }
 
-        size_type RemoveOption(const set_t<string_t>& keys)
-        {
-            size_type n = 0;
-            for (auto key : keys)
-            {
-                auto iter = key_map.find(key);
-                if (iter != key_map.end())
-                {
-                    _RemoveOption(iter->second, key);
-                    key_map.erase(iter);
-                    ++n;
-                }
-            }
+        operator bool() const { return is_valid(); }
+        operator const string_t& () const { return info(); }
 
-            return n;
+        template<typename _OptionType>
+        bool is_existing() const
+        {
+            static_assert(_index<_OptionType> < _size, "the option isn't a member of the parser.");
+            return _existing.test(_index<_OptionType>);
         }
 
-        bool IsValid(const string_t& key) const
+        template<typename _OptionType>
+        bool has_value() const
         {
-            return (key_map.find(key) != key_map.end());
+            static_assert(_index<_OptionType> < _size, "the option isn't a member of the parser.");
+            return _valued.test(_index<_OptionType>);
         }
 
-        bool IsSame(const string_t& k1, const string_t& k2) const
+        template<typename _OptionType>
+        const typename _OptionType::value_type& get() const
         {
-            auto iter1 = key_map.find(k1);
-            if (iter1 == key_map.end()) return false;
-
-            auto iter2 = key_map.find(k2);
-            if (iter2 == key_map.end()) return false;
+            if (!has_value<_OptionType>())
+                throw std::out_of_range(R"(parameter ")" + string_t(*std::begin(_OptionType::keys)) + R"(" has no value.)");
 
-            return (iter1->second == iter2->second);
+            return std::get<_index<_OptionType>>(_values);
         }
 
-        const option_t* GetOption(const string_t& key) const
+        template<typename _OptionType>
+        typename _OptionType::value_type get(const typename _OptionType::value_type& value) const
         {
-            auto iter = key_map.find(key);
-            if (iter != key_map.end())
-                return &opt_map.at(iter->second).second;
-
-            return nullptr;
+            return (has_value<_OptionType>() ? std::get<_index<_OptionType>>(_values) : value);
         }
 
-        set_t<string_t> GetKeys(const string_t& key) const
+    private:
+
+        void _set_error(state_t s, std::string_view a = std::string_view(), std::string_view b = std::string_view())
         {
-            set_t<string_t> keys;
-            auto iter = key_map.find(key);
-            if (iter != key_map.end())
-                keys = opt_map.at(iter->second).first;
+            _state = s;
+            _extra.first.assign(a.data(), a.size());
+            _extra.second.assign(b.data(), b.size());
 
-            return keys;
+            _info = _make_info(_state, _extra.first, _extra.second);
         }
 
-        set_t<string_t> GetKeys() const
-        {
-            set_t<string_t> keys;
-            for (auto v : key_map)
-                keys.emplace(v.first);
+    };  // class static_result_t
 
-            return keys;
-        }
+    // 使用编译期参数表的解析器, 规则与 Parser 相同
+    // 参数名在编译期按长度分组排序, 匹配时从最长的一组开始, 每组只比较输入的同长前缀并二分查找
+    // 结果按参数类型取值, 不需要 std::variant
+    // 值类型为 std::string_view 的参数借用输入参数的内存
+    template<typename... _Options>
+    class StaticParser
+    {
+    public:
 
+        using result_type = static_result_t<_Options...>;
         using const_char_ptr = const string_t::value_type*;
 
-        result_t Parse(const const_char_ptr* argv, size_type from, unsigned int to) const
+        result_type Parse(const const_char_ptr* argv, size_type from, size_type to) const
         {
-            return Parse(list_t<string_t>(argv + from, argv + to));
+            return _Parse(argv + from, argv + to);
         }
 
         template<size_type n>
-        result_t Parse(const const_char_ptr(&argv)[n], unsigned int from) const
+        result_type Parse(const const_char_ptr(&argv)[n]) const
         {
-            return Parse(argv, from, n);
+            return _Parse(argv, argv + n);
         }
 
-        template<size_type n>
-        result_t Parse(const const_char_ptr(&argv)[n]) const
+        result_type Parse(const std::string_view* args, size_type n) const
         {
-            return Parse(argv, 0, n);
+            return _Parse(args, args + n);
         }
 
-        result_t Parse(const list_t<string_t>& args) const
+        result_type Parse(const list_t<string_t>& args) const
         {
-            if (args.empty())
-                return result_t(state_t::s_nothing, R"(error: don't get any parameter.)");
-
-            return _Parse(args, { &Parser::_OnKey, &Parser::_OnValue, &Parser::_OnOptional });
+            return _Parse(args.begin(), args.end());
         }
 
     private:
 
-        using id_type = unsigned int;
-        using _parse_func_type = size_type(Parser::*)(result_t&, const string_t&, const list_t<string_t>&, string_t&, option_t&) const;
+        static constexpr size_type _size = sizeof...(_Options);
+        static constexpr size_type npos = _size;
 
-        id_type option_id{ 0 };
-        map_t<string_t, id_type> key_map;
-        map_t<id_type, pair_t<set_t<string_t>, option_t>> opt_map;
+        static constexpr bool _unique[] = { _Options::is_unique..., false };
+        static constexpr bool _k_required[] = { _Options::is_key_required..., false };
+        static constexpr bool _v_required[] = { _Options::is_value_required..., false };
+        static constexpr bool _nothing[] = { std::is_same_v<typename _Options::value_type, std::nullptr_t>..., false };
+        static constexpr std::string_view _primary[] = { std::string_view(*std::begin(_Options::keys))..., std::string_view() };
 
         enum { on_key, on_value, on_opt, parse_error };
 
-        void _update_option_id() { ++option_id; }
+        struct _match_type
+        {
+            size_type index;
+            std::string_view key;
+        };
 
-        const option_t& _Option(const string_t& key) const
+        static constexpr size_type _key_count = (std::size(_Options::keys) + ... + 0);
+        static constexpr auto _key_table = _make_static_keys<_key_count, _Options...>(std::index_sequence_for<_Options...>());
+        static constexpr auto _key_groups = _make_static_groups<_count_static_groups(_key_table)>(_key_table);
+
+        // 最长的前缀参数名, 其后必须是结尾或'='
+        static constexpr _match_type _match(std::string_view arg)
         {
-            return opt_map.at(key_map.at(key)).second;
+            for (const _static_group_t& group : _key_groups)
+            {
+                if (arg.size() < group.length)
+                    continue;
+
+                std::string_view prefix = arg.substr(0, group.length);
+                size_type first = group.first, last = group.last;
+                while (first < last)
+                {
+                    size_type mid = first + (last - first) / 2;
+                    if (_key_table[mid].key < prefix)
+                        first = mid + 1;
+                    else
+                        last = mid;
+                }
+
+                if (first < group.last && _key_table[first].key == prefix)
+                    return { _key_table[first].index, _key_table[first].key };
+            }
+
+            return { npos, std::string_view() };
         }
 
-        const set_t<string_t>& _Keys(const string_t& key) const
+        template<size_type i>
+        static bool _set_value(result_type& result, std::string_view value)
         {
-            return opt_map.at(key_map.at(key)).first;
+            using _OptionType = std::tuple_element_t<i, std::tuple<_Options...>>;
+
+            if constexpr (std::is_same_v<typename _OptionType::value_type, std::nullptr_t>)
+            {
+                return false;
+            }
+            else
+            {
+                if constexpr (_has_check<_OptionType>::value)
+                {
+                    if (!_OptionType::check(value))
+                        return false;
+                }
+
+                if (!_convert(value, std::get<i>(result._values)))
+                    return false;
+
+                result._valued.set(i);
+                return true;
+            }
         }
 
-        template<size_type n>
-        result_t _Parse(const list_t<string_t>& args, const _parse_func_type(&_parse_functions)[n]) const
+        template<size_type... i>
+        static bool _set_value(size_type index, result_type& result, std::string_view value, std::index_sequence<i...>)
         {
-            string_t key;
-            option_t opt;
-            size_type index(on_key);
+            bool ok = false;
+            ((index == i ? (ok = _set_value<i>(result, value), true) : false) || ...);
+            return ok;
+        }
 
-            list_t<string_t> keys;
-            for (auto v : key_map) keys.emplace_back(v.first);
-            std::sort(keys.begin(), keys.end(), [](const string_t& a, const string_t& b) { return (b.size() < a.size()); });
+        template<typename _IterType>
+        result_type _Parse(_IterType first, _IterType last) const
+        {
+            result_type result;
+            if (first == last)
+            {
+                result._set_error(state_t::s_nothing);
+                return result;
+            }
 
-            result_t result(state_t::s_ok, "ok");
+            _match_type k{ npos, std::string_view() };
+            size_type index(on_key);
 
-            for (auto arg : args)
+            for (; first != last && parse_error != index; ++first)
             {
-                if (index < n)
-                    index = (this->*_parse_functions[index])(result, arg, keys, key, opt);
-                else
+                std::string_view arg(*first);
+                switch (index)
+                {
+                case on_key:
+                    index = _OnKey(result, arg, k);
+                    break;
+                case on_value:
+                    index = _OnValue(result, k, arg);
+                    break;
+                case on_opt:
+                    index = _OnOptional(result, arg, k);
                     break;
+                default:
+                    break;
+                }
             }
 
             switch (index)
             {
-            case on_opt:
-                result._add_value(key, _Keys(key));
             case on_key:
+            case on_opt:
                 _CheckResult(result);
                 break;
             case on_value:
-                result._set_error(state_t::s_v_missing, key);
+                result._set_error(state_t::s_v_missing, k.key);
                 break;
             default:
                 break;
@@ -499,157 +4399,118 @@ namespace xf::cmd
             return result;
         }
 
-        size_type _OnKey(result_t& result, const string_t& arg, const list_t<string_t>& keys, string_t& k, option_t& opt) const
+        static size_type _OnKey(result_type& result, std::string_view arg, _match_type& k)
         {
-            for (auto key : keys)
+            _match_type m = _match(arg);
+            if (npos != m.index)
             {
-                if (_start_with(arg, key))
-                {
-                    if (_is_perfect_match(arg, key))
-                        return _OnPerfectMatch(result, key, k, opt);
+                if (arg.size() == m.key.size())
+                    return _OnPerfectMatch(result, m, k);
 
-                    if (_is_equation(arg, key))
-                        return _OnEquation(result, key, arg.substr(key.size() + 1), _Option(key));
-
-                    break;
-                }
+                if (m.key.size() + 1 < arg.size() && '=' == arg[m.key.size()])
+                    return _OnEquation(result, m, arg.substr(m.key.size() + 1));
             }
 
             result._set_error(state_t::s_k_unrecognized, arg);
             return parse_error;
         }
 
-        size_type _OnValue(result_t& result, const string_t& arg, const list_t<string_t>& keys, string_t& k, option_t& opt) const
-        {
-            return _OnValueEx(result, k, arg, opt);
-        }
-
-        size_type _OnOptional(result_t& result, const string_t& arg, const list_t<string_t>& keys, string_t& k, option_t& opt) const
+        static size_type _OnOptional(result_type& result, std::string_view arg, _match_type& k)
         {
-            if (opt.is_unique())
-                return _OnValueEx(result, k, arg, opt);
-
-            for (auto key : keys)
+            if (!_unique[k.index])
             {
-                if (_start_with(arg, key))
+                _match_type m = _match(arg);
+                if (npos != m.index)
                 {
-                    if (_is_perfect_match(arg, key))
-                    {
-                        result._add_value(k, _Keys(k));
-                        return _OnPerfectMatch(result, key, k, opt);
-                    }
-
-                    if (_is_equation(arg, key))
-                    {
-                        result._add_value(k, _Keys(k));
-                        return _OnEquation(result, key, arg.substr(key.size() + 1), _Option(key));
-                    }
+                    if (arg.size() == m.key.size())
+                        return _OnPerfectMatch(result, m, k);
 
-                    break;
+                    if (m.key.size() + 1 < arg.size() && '=' == arg[m.key.size()])
+                        return _OnEquation(result, m, arg.substr(m.key.size() + 1));
                 }
             }
 
-            return _OnValue(result, arg, keys, k, opt);
+            return _OnValue(result, k, arg);
         }
 
-        size_type _OnPerfectMatch(result_t& result, const string_t& key, string_t& k, option_t& opt) const
+        static size_type _OnPerfectMatch(result_type& result, const _match_type& m, _match_type& k)
         {
-            opt = _Option(key);
-            if (!result._check_key(key, opt))
+            if (!_CheckKey(result, m))
                 return parse_error;
 
-            k = key;
-            if (value_t::vt_nothing == opt.value_type())
-            {
-                result._add_value(key, nullptr, _Keys(key));
+            k = m;
+            if (_nothing[m.index])
                 return on_key;
-            }
 
-            return (opt.is_value_required() ? on_value : on_opt);
+            return (_v_required[m.index] ? on_value : on_opt);
         }
 
-        size_type _OnEquation(result_t& result, const string_t& key, const string_t& value, const option_t& opt) const
+        static size_type _OnEquation(result_type& result, const _match_type& m, std::string_view value)
         {
-            if (!result._check_key(key, opt))
+            if (!_CheckKey(result, m))
                 return parse_error;
 
-            if (value_t::vt_nothing == opt.value_type())
+            if (_nothing[m.index])
             {
-                result._set_error(state_t::s_v_redundant, key);
+                result._set_error(state_t::s_v_redundant, m.key);
                 return parse_error;
             }
 
-            return _OnValueEx(result, key, value, opt);
+            return _OnValue(result, m, value);
         }
 
-        size_type _OnValueEx(result_t& result, const string_t& key, const string_t& value, const option_t& opt) const
+        static size_type _OnValue(result_type& result, const _match_type& m, std::string_view value)
         {
-            if (opt.check(value))
-            {
-                result._add_value(key, value, _Keys(key), opt);
+            if (_set_value(m.index, result, value, std::index_sequence_for<_Options...>()))
                 return on_key;
-            }
 
-            result._set_error(state_t::s_v_error, key, value);
+            result._set_error(state_t::s_v_error, m.key, value);
             return parse_error;
         }
 
-        bool _RemoveOption(id_type id, const string_t& key)
+        static bool _CheckKey(result_type& result, const _match_type& m)
         {
-            auto iter = opt_map.find(id);
-            if (iter != opt_map.end())
+            if (result._existing.none())
             {
-                iter->second.first.erase(key);
-                if (iter->second.first.empty())
-                    opt_map.erase(iter);
-
-                return true;
+                result._is_unique = _unique[m.index];
+                result._first = m.key;
+            }
+            else if (result._is_unique)
+            {
+                result._set_error(state_t::s_k_conflict, result._first);
+                return false;
+            }
+            else if (_unique[m.index])
+            {
+                result._set_error(state_t::s_k_conflict, m.key);
+                return false;
+            }
+            else if (result._existing.test(m.index))
+            {
+                result._set_error(state_t::s_k_duplicated, result._keys[m.index], m.key);
+                return false;
             }
 
-            return false;
+            result._existing.set(m.index);
+            result._keys[m.index] = m.key;
+            return true;
         }
 
-        bool _CheckResult(result_t& result) const
+        static void _CheckResult(result_type& result)
         {
-            if (state_t::s_ok == result.code())
-            {
-                if (_Option(result._k_map.cbegin()->first).is_unique())
-                    return true;
+            if (result._is_unique)
+                return;
 
-                for (auto opt : opt_map)
+            for (size_type n = 0; n < _size; ++n)
+            {
+                if (_k_required[n] && !result._existing.test(n))
                 {
-                    if (opt.second.second.is_key_required())
-                    {
-                        const string_t& key(*opt.second.first.cbegin());
-                        if (!result.is_existing(key))
-                        {
-                            result._set_error(state_t::s_k_missing, key);
-                            return false;
-                        }
-                    }
+                    result._set_error(state_t::s_k_missing, _primary[n]);
+                    return;
                 }
-
-                return true;
             }
-
-            return false;
-        }
-
-        static bool _is_perfect_match(const string_t& text, const string_t& key)
-        {
-            return (text.size() == key.size());
         }
 
-        static bool _is_equation(const string_t& text, const string_t& key)
-        {
-            return ((key.size() + 1) < text.size() && '=' == text[key.size()]);
-        }
-
-        static bool _start_with(const string_t& a, const string_t& b)
-        {
-            return 0 == a.compare(0, b.size(), b);
-        }
-
-    };  // class Parser
+    };  // class StaticParser
 
 }   // namespace xf::cmd